@@ -48,9 +48,13 @@ Scene::GameScene::Builder App::Make(int argc, char *argv[])
         .build();
 
     Core::Engine::Search::Options engine;
-    engine.maxDepth = parser.max_depth().value_or(Core::Logic::MAX_HISTORY_SIZE - 1);
+    engine.maxDepth = parser.max_depth().value_or(Core::Logic::MAX_PLY);
     engine.timeSec = parser.time_limit().value_or(3);
     engine.ttSizeMB = parser.tt_size().value_or(64);
+    engine.threads = parser.threads().value_or(1);
+    engine.ttFile = parser.tt_file().value_or("");
+    engine.ttVerify = parser.tt_verify().value_or(false);
+    engine.nnueFile = parser.nnue_file().value_or("");
 
     return Scene::GameScene::Builder()
             .setBoardView(board)
@@ -72,6 +72,39 @@ std::optional<uint32_t> Parser::tt_size() const
     return std::nullopt;
 }
 
+std::optional<uint16_t> Parser::threads() const
+{
+    if(const std::string* threads = find("threads")) {
+        try {return std::stoi(*threads);}
+        catch(const std::exception& e) {std::cerr << e.what();}
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> Parser::tt_file() const
+{
+    if(const std::string* file = find("tt-file")) {
+        return *file;
+    }
+    return std::nullopt;
+}
+
+std::optional<bool> Parser::tt_verify() const
+{
+    if(const std::string* verify = find("tt-verify")) {
+        return *verify == "1" || *verify == "true";
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> Parser::nnue_file() const
+{
+    if(const std::string* file = find("nnue")) {
+        return *file;
+    }
+    return std::nullopt;
+}
+
 std::optional<std::string> Parser::log() const
 {
     if(const std::string* log = find("log")) {
@@ -16,6 +16,10 @@ public:
     std::optional<uint16_t> time_limit() const;
     std::optional<uint8_t> max_depth() const;
     std::optional<uint32_t> tt_size() const;
+    std::optional<uint16_t> threads() const;
+    std::optional<std::string> tt_file() const;
+    std::optional<bool> tt_verify() const;
+    std::optional<std::string> nnue_file() const;
     std::optional<std::string> log() const;
 
 private:
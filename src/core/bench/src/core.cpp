@@ -0,0 +1,348 @@
+#include "engine/eval.hpp"
+#include "engine/nnue.hpp"
+#include "engine/pick.hpp"
+#include "engine/tt.hpp"
+#include "logic/attack.hpp"
+#include "logic/movelist.hpp"
+#include "logic/position.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+Микро-замеры горячих примитивов ядра (Google Benchmark).
+Каждая итерация проходит по всем Positions, items_per_second - вызовы примитива в секунду.
+JSON для отслеживания динамики:
+core_bench --benchmark_out=core_bench.json --benchmark_out_format=json
+*/
+
+using namespace Core;
+
+namespace
+{
+
+const std::vector<std::string> Positions = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r2q1rk1/ppp2ppp/2n1bn2/2b1p3/3pP3/3P1NPP/PPP1NPB1/R1BQ1RK1 b - - 0 9",
+    "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+};
+
+template<typename Position = Logic::PositionFM>
+std::vector<Position> MakePositions()
+{
+    // позиции нельзя копировать (история хранится в своем массиве), только строить на месте
+    std::vector<Position> res;
+    res.reserve(Positions.size());
+    for(const std::string& fen : Positions) {
+        res.emplace_back(fen);
+        res.back().UpdateAttacks();
+    }
+    return res;
+}
+
+void GetFastAttack(benchmark::State& state, Logic::PieceType type)
+{
+    const Logic::Piece piece = type;
+    std::vector<Logic::Bitboard> blockers;
+    for(const auto& pos : MakePositions())
+        blockers.push_back(pos.GetOccupied(Logic::WHITE, Logic::BLACK));
+
+    for(auto _ : state) {
+        for(Logic::Bitboard occ : blockers) {
+            for(int sq = 0; sq < Logic::SQUARE_COUNT; ++sq) {
+                Logic::AttackParams params;
+                params.set_attacker(Logic::Square(sq)).set_blockers(occ).set_color(Logic::WHITE);
+                benchmark::DoNotOptimize(Logic::GetFastAttack(piece, params));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * blockers.size() * Logic::SQUARE_COUNT);
+}
+BENCHMARK_CAPTURE(GetFastAttack, King, Logic::KING);
+BENCHMARK_CAPTURE(GetFastAttack, Queen, Logic::QUEEN);
+BENCHMARK_CAPTURE(GetFastAttack, Pawn, Logic::PAWN);
+BENCHMARK_CAPTURE(GetFastAttack, Knight, Logic::KNIGHT);
+BENCHMARK_CAPTURE(GetFastAttack, Bishop, Logic::BISHOP);
+BENCHMARK_CAPTURE(GetFastAttack, Rook, Logic::ROOK);
+
+// PEXT против fancy magic на одной машине: запускать на каждом семействе процессоров
+void SliderBackend(benchmark::State& state, Logic::SliderBackend backend)
+{
+    if(!Logic::HasSliderBackend(backend)) {
+        state.SkipWithError("backend is not compiled in (ATTEMPT_SLIDER_ATTACKS)");
+        return;
+    }
+
+    std::vector<Logic::Bitboard> blockers;
+    for(const auto& pos : MakePositions())
+        blockers.push_back(pos.GetOccupied(Logic::WHITE, Logic::BLACK));
+
+    const Logic::SliderBackend saved = Logic::GetSliderBackend();
+    Logic::SetSliderBackend(backend);
+
+    for(auto _ : state) {
+        for(Logic::Bitboard occ : blockers) {
+            for(int sq = 0; sq < Logic::SQUARE_COUNT; ++sq) {
+                Logic::AttackParams params;
+                params.set_attacker(Logic::Square(sq)).set_blockers(occ);
+                benchmark::DoNotOptimize(Logic::GetFastAttack(Logic::QUEEN, params));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * blockers.size() * Logic::SQUARE_COUNT);
+
+    Logic::SetSliderBackend(saved);
+}
+BENCHMARK_CAPTURE(SliderBackend, Pext, Logic::SliderBackend::Pext);
+BENCHMARK_CAPTURE(SliderBackend, Magic, Logic::SliderBackend::Magic);
+
+template<Logic::MoveGenType MGT>
+void Generate(benchmark::State& state)
+{
+    auto positions = MakePositions();
+
+    for(auto _ : state) {
+        for(const auto& pos : positions) {
+            Logic::MoveList moves;
+            moves.generate<MGT>(pos);
+            benchmark::DoNotOptimize(moves.get_size());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK_TEMPLATE(Generate, Logic::MoveGenType::All);
+BENCHMARK_TEMPLATE(Generate, Logic::MoveGenType::Forced);
+
+template<Logic::MoveGenType MGT>
+void Count(benchmark::State& state)
+{
+    auto positions = MakePositions();
+
+    for(auto _ : state)
+        for(const auto& pos : positions)
+            benchmark::DoNotOptimize(Logic::MoveList::count<MGT>(pos));
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+BENCHMARK_TEMPLATE(Count, Logic::MoveGenType::All);
+BENCHMARK_TEMPLATE(Count, Logic::MoveGenType::Forced);
+
+// make/unmake (StaticStorage) против copy-make (CopyStorage)
+template<Logic::StorageType Storage>
+void DoUndoMove(benchmark::State& state)
+{
+    auto positions = MakePositions<Logic::Position<Storage>>();
+    std::vector<Logic::MoveList> moves(positions.size());
+    long long count = 0;
+    for(size_t i = 0; i < positions.size(); ++i) {
+        moves[i].generate<Logic::MoveGenType::All>(positions[i]);
+        count += moves[i].get_size();
+    }
+
+    for(auto _ : state) {
+        for(size_t i = 0; i < positions.size(); ++i) {
+            for(Logic::Move move : moves[i]) {
+                positions[i].DoMove(move);
+                positions[i].UndoMove();
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(DoUndoMove, Logic::StaticStorage);
+BENCHMARK_TEMPLATE(DoUndoMove, Logic::CopyStorage);
+
+// UpdateAttacks после хода (повторный вызов в той же позиции ничего не считает), 
+// map:1 - плюс карта атак соперника (GetAttackers); в items входят DoMove/UndoMove
+void UpdateAttacks(benchmark::State& state)
+{
+    auto positions = MakePositions();
+    std::vector<Logic::MoveList> moves(positions.size());
+    long long count = 0;
+    for(size_t i = 0; i < positions.size(); ++i) {
+        moves[i].generate<Logic::MoveGenType::All>(positions[i]);
+        count += moves[i].get_size();
+    }
+
+    for(auto _ : state) {
+        for(size_t i = 0; i < positions.size(); ++i) {
+            for(Logic::Move move : moves[i]) {
+                positions[i].DoMove(move);
+                positions[i].UpdateAttacks();
+                if(state.range(0))
+                    benchmark::DoNotOptimize(positions[i].GetAttackers());
+                positions[i].UndoMove();
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(UpdateAttacks)->ArgName("map")->Arg(0)->Arg(1);
+
+// IsDraw после каждого хода узла, как в negamax: партия из game ply тихих ходов без взятий и пешек
+// (повторения ищутся на всю ее длину) и 8 ply поиска от нее; в items входят DoMove/UndoMove
+void IsDraw(benchmark::State& state)
+{
+    constexpr int SearchPlies = 8;
+    std::mt19937 rng(7);
+
+    // под шахом Quiet пуст, поэтому взятия отсеиваются из All
+    auto randomQuiet = [&rng](auto& pos) {
+        pos.UpdateAttacks();
+        Logic::MoveList moves;
+        moves.generate<Logic::MoveGenType::All>(pos);
+        std::vector<Logic::Move> quiet;
+        for(Logic::Move move : moves)
+            if(!pos.GetPiece(move.targ()).isValid())
+                quiet.push_back(move);
+        pos.DoMove(quiet[rng() % quiet.size()]);
+    };
+
+    Logic::PositionDM game("r3k2r/8/2n2b2/8/8/2N2B2/8/R3K2R w KQkq - 0 1");
+    for(int ply = 0; ply < state.range(0); ++ply)
+        randomQuiet(game);
+
+    Logic::PositionFM pos(game);
+    for(int ply = 0; ply < SearchPlies; ++ply)
+        randomQuiet(pos);
+
+    pos.UpdateAttacks();
+    Logic::MoveList moves;
+    moves.generate<Logic::MoveGenType::All>(pos);
+
+    for(auto _ : state) {
+        for(Logic::Move move : moves) {
+            pos.DoMove(move);
+            benchmark::DoNotOptimize(pos.IsDraw(game.GetHistory()));
+            pos.UndoMove();
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * moves.get_size());
+}
+BENCHMARK(IsDraw)->ArgName("game")->Arg(0)->Arg(30)->Arg(80);
+
+// SEE всех взятий позиции (то, что MovePicker считает для каждого взятия при сортировке)
+void See(benchmark::State& state)
+{
+    auto positions = MakePositions();
+    std::vector<std::unique_ptr<Engine::MovePicker>> pickers;
+    std::vector<Logic::MoveList> captures(positions.size());
+    long long count = 0;
+    for(size_t i = 0; i < positions.size(); ++i) {
+        pickers.push_back(std::make_unique<Engine::MovePicker>(positions[i]));
+        captures[i].generate<Logic::MoveGenType::Forced>(positions[i]);
+        count += captures[i].get_size();
+    }
+
+    for(auto _ : state) {
+        for(size_t i = 0; i < positions.size(); ++i)
+            for(Logic::Move move : captures[i])
+                benchmark::DoNotOptimize(pickers[i]->See(move));
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(See);
+
+// Update + Rollback оценки по всем ходам позиций (DoMove/UndoMove входят в замер, см. DoUndoMove)
+void EvaluationUpdate(benchmark::State& state)
+{
+    Engine::Evaluation::Setup();
+
+    std::unique_ptr<Engine::NNUE::Network> network;
+    if(state.range(0)) {
+        network = std::make_unique<Engine::NNUE::Network>();
+        network->Randomize(1);
+    }
+
+    auto positions = MakePositions();
+    std::vector<Logic::MoveList> moves(positions.size());
+    std::vector<std::unique_ptr<Engine::Evaluation>> evals;
+    long long count = 0;
+    for(size_t i = 0; i < positions.size(); ++i) {
+        moves[i].generate<Logic::MoveGenType::All>(positions[i]);
+        count += moves[i].get_size();
+        evals.push_back(std::make_unique<Engine::Evaluation>(network.get()));
+        evals.back()->Init(positions[i]);
+    }
+
+    for(auto _ : state) {
+        for(size_t i = 0; i < positions.size(); ++i) {
+            for(Logic::Move move : moves[i]) {
+                positions[i].DoMove(move);
+                evals[i]->Update(move);
+                evals[i]->Rollback();
+                positions[i].UndoMove();
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(EvaluationUpdate)->ArgName("nnue")->Arg(0)->Arg(1);
+
+// ключи генерируются на ходу: заранее сохраненный набор ключей целиком помещается в кэш
+// и скрыл бы промахи памяти, ради которых таблицу меряют на разных размерах
+struct KeyStream {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    uint64_t next() noexcept {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+};
+
+void TTStore(benchmark::State& state)
+{
+    Engine::Transposition tt;
+    tt.resize(state.range(0));
+    KeyStream keys;
+
+    for(auto _ : state) {
+        const uint64_t key = keys.next();
+        tt.store(key, int16_t(key), Logic::Move(uint16_t(key >> 16)), uint8_t(key >> 32) & 31, Engine::EntryType::Exact);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(TTStore)->ArgName("MB")->Arg(1)->Arg(16)->Arg(256);
+
+// таблица заполнена ключами того же потока, поэтому часть запросов попадает
+void TTProbe(benchmark::State& state)
+{
+    Engine::Transposition tt;
+    tt.resize(state.range(0));
+    KeyStream fill;
+    for(size_t i = 0; i < (size_t(state.range(0)) << 20) / 8; ++i)
+        tt.store(fill.next(), 0, {}, 10, Engine::EntryType::Exact);
+
+    KeyStream keys;
+    for(auto _ : state)
+        benchmark::DoNotOptimize(tt.probe(keys.next(), 5, -Logic::INF, Logic::INF));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(TTProbe)->ArgName("MB")->Arg(1)->Arg(16)->Arg(256);
+
+}
+
+int main(int argc, char** argv)
+{
+    // какой бэкенд выбрал cpuid, попадает в шапку вывода и в JSON
+    benchmark::AddCustomContext(
+        "slider_backend", Logic::GetSliderBackend() == Logic::SliderBackend::Pext ? "pext" : "magic"
+    );
+
+    benchmark::Initialize(&argc, argv);
+    if(benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
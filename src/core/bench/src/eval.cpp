@@ -0,0 +1,197 @@
+#include "engine/eval.hpp"
+#include "engine/nnue.hpp"
+#include "engine/search.hpp"
+#include "logic/movelist.hpp"
+#include "logic/position.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+PeSTO без пешечной структуры, PeSTO с ней (PawnTable) и NNUE:
+evals/sec - Update + Score + Rollback по всем ходам позиций (так оценка вызывается в поиске),
+pawn hits - попадания в PawnTable за поиск,
+eval hits - статические оценки из EvalCache и записей TT (кэш работает только с NNUE, строка nnue+cache),
+nps - поиск в 1 поток с ограничением по времени на позицию
+(до фиксированной глубины нельзя: со случайными весами дерево на порядки больше).
+Без файла сети используются случайные веса: скорость от значений не зависит,
+но деревья поиска у двух оценок разные, поэтому сравнивать стоит nps, а не узлы.
+usage: eval_bench [sec per position] [network file]
+*/
+
+using namespace Core;
+
+namespace
+{
+
+const std::vector<std::string> Positions = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP1B1PPP/R2QKB1R w KQ - 0 8",
+    "r2q1rk1/ppp2ppp/2n1bn2/2b1p3/3pP3/3P1NPP/PPP1NPB1/R1BQ1RK1 b - - 0 9",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+};
+
+constexpr int EvalRounds = 10000;
+constexpr int EvalRepeats = 5;
+
+struct SearchSample {
+    double nps;
+    double pawnHitRate;
+    double evalHitRate;
+};
+
+double EvalsPerSec(const Engine::NNUE::Network* network, bool pawnStructure)
+{
+    long long checksum = 0;
+    double best = 0;
+
+    // лучший из нескольких прогонов: замер короткий и чувствителен к шуму
+    for(int repeat = 0; repeat < EvalRepeats; ++repeat)
+    {
+        long long evals = 0;
+        const auto start = std::chrono::steady_clock::now();
+
+        for(const std::string& fen : Positions) {
+            Logic::PositionFM pos(fen);
+            Logic::MoveGenerator<Logic::MoveGenType::All> gen(pos);
+
+            auto eval = std::make_unique<Engine::Evaluation>(network, pawnStructure);
+            eval->Init(pos);
+
+            for(int round = 0; round < EvalRounds; ++round) {
+                for(Logic::Move move : gen.moves) {
+                    pos.DoMove(move);
+                    eval->Update(move);
+                    checksum += eval->Score();
+                    eval->Rollback();
+                    pos.UndoMove();
+                    ++evals;
+                }
+            }
+        }
+
+        const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = std::max(best, evals / sec);
+    }
+
+    // не даем компилятору выбросить вычисления
+    benchmark::DoNotOptimize(checksum);
+
+    return best;
+}
+
+SearchSample RunSearch(const std::string& nnueFile, bool pawnStructure, bool evalCache, int seconds)
+{
+    long long nodes = 0;
+    long long pawnProbes = 0;
+    long long pawnHits = 0;
+    long long evalProbes = 0;
+    long long evalHits = 0;
+    double sec = 0;
+
+    for(const std::string& fen : Positions) {
+        Logic::PositionDM pos(fen);
+
+        std::promise<Engine::Search::Info> done;
+        std::future<Engine::Search::Info> result = done.get_future();
+
+        Engine::Search::Options options;
+        options.timeSec = seconds;
+        options.ttSizeMB = 64;
+        options.maxDepth = Logic::MAX_PLY;
+        options.nnueFile = nnueFile;
+        options.pawnStructure = pawnStructure;
+        options.evalCache = evalCache;
+        options.onMove = [&done](Engine::Search::Info info) {done.set_value(info);};
+
+        Engine::Search search;
+        search.Init(options);
+        search.SetPosition(pos);
+        search.Launch();
+
+        const auto start = std::chrono::steady_clock::now();
+        search.Think();
+        const Engine::Search::Info info = result.get();
+        sec += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        nodes += info.nodes;
+        pawnProbes += info.pawn_probes;
+        pawnHits += info.pawn_hits;
+        evalProbes += info.eval_probes;
+        evalHits += info.eval_cache_hits + info.eval_tt_hits;
+    }
+
+    return {
+        nodes / sec, 
+        100.0 * pawnHits / std::max(1LL, pawnProbes),
+        100.0 * evalHits / std::max(1LL, evalProbes)
+    };
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int seconds = argc > 1 ? std::stoi(argv[1]) : 2;
+    std::string file = argc > 2 ? argv[2] : "";
+
+    Engine::Evaluation::Setup();
+
+    auto network = std::make_unique<Engine::NNUE::Network>();
+    if(file.empty()) {
+        file = (std::filesystem::temp_directory_path() / "attempt101_bench.nnue").string();
+        network->Randomize(1);
+        network->Save(file);
+    } else if(!network->Load(file)) {
+        std::cerr << "failed to load network from " << file << '\n';
+        return 1;
+    }
+
+    std::cout << std::format("nnue kernel: {}, hidden size {}\n\n", Engine::NNUE::Network::Kernel(), Engine::NNUE::HiddenSize);
+    std::cout << std::format(
+        "{:>10} {:>14} {:>14} {:>11} {:>11}\n", "eval", "evals/sec", "nps", "pawn hits", "eval hits"
+    );
+
+    auto row = [&](const char* name, const Engine::NNUE::Network* net, bool pawns, bool cache) {
+        const double evals = EvalsPerSec(net, pawns);
+        const SearchSample sample = RunSearch(net ? file : "", pawns, cache, seconds);
+        std::cout << std::format(
+            "{:>10} {:>14.0f} {:>14.0f} {:>10.1f}% {:>10.1f}%\n", 
+            name, evals, sample.nps, sample.pawnHitRate, sample.evalHitRate
+        );
+        return std::make_pair(evals, sample.nps);
+    };
+
+    const auto [psqtEvals, psqtNps] = row("psqt", nullptr, false, false);
+    const auto [pawnEvals, pawnNps] = row("psqt+pawn", nullptr, true, false);
+    const auto [nnueEvals, nnueNps] = row("nnue", network.get(), false, false);
+    const double nnueCacheNps = row("nnue+cache", network.get(), false, true).second;
+
+    std::cout << std::format(
+        "\npsqt+pawn / psqt: evals {:.2f}x, nps {:.2f}x\n",
+        pawnEvals / psqtEvals, pawnNps / psqtNps
+    );
+    std::cout << std::format(
+        "nnue / psqt: evals {:.2f}x, nps {:.2f}x\n",
+        nnueEvals / psqtEvals, nnueNps / psqtNps
+    );
+    std::cout << std::format(
+        "nnue+cache / nnue: nps {:.2f}x\n",
+        nnueCacheNps / nnueNps
+    );
+
+    if(argc <= 2)
+        std::filesystem::remove(file);
+}
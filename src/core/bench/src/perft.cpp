@@ -0,0 +1,290 @@
+#include "logic/movelist.hpp"
+#include "logic/position.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/*
+Параллельный perft для проверки генератора ходов.
+Ходы корня раздаются потокам по одному (кто освободился, берет следующий),
+у каждого потока своя позиция. Счетчики поддеревьев кэшируются в общей
+хэш-таблице по ключу (Zobrist, глубина), на последнем ply ходы не делаются
+и даже не записываются, а считаются MoveList::count (bulk counting).
+usage: perft [--depth 6] [--fen <fen>] [--threads N] [--hash MB (0 - без таблицы)] [--no-bulk] [--copy-make] [--suite]
+--suite - позиции из тестов NodeCounter с известными числами узлов
+--copy-make - позиции с CopyStorage вместо make/unmake (StaticStorage); 
+с bulk counting ходы последнего ply не делаются, разница режимов виднее с --no-bulk
+*/
+
+using namespace Core;
+
+namespace
+{
+
+struct SuiteCase {
+    std::string_view fen;
+    int depth;
+    uint64_t expected;
+};
+
+constexpr SuiteCase Suite[] = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 6, 119060324},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 5, 193690690},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6, 11030083},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5, 15833292},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 5, 89941194},
+    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 5, 164075551},
+};
+
+/*
+Запись без блокировок: check = key ^ count. Если другой поток перезаписал
+запись между чтениями, проверка не сойдется и запись считается пустой.
+Глубина подмешивается в ключ, так что одна позиция на разных глубинах - разные записи.
+*/
+class PerftHash {
+public:
+
+    explicit PerftHash(size_t mb) 
+    {
+        size_t count = 1;
+        while(count * 2 * sizeof(Entry) <= (mb << 20))
+            count *= 2;
+        size = mb ? count : 0;
+        entries = std::make_unique<Entry[]>(size);
+    }
+
+    bool probe(uint64_t hash, int depth, uint64_t& count) const noexcept 
+    {
+        if(!size)
+            return false;
+
+        const uint64_t key = mix(hash, depth);
+        const Entry& entry = entries[key & (size - 1)];
+
+        count = entry.count.load(std::memory_order_relaxed);
+        return (entry.check.load(std::memory_order_relaxed) ^ count) == key;
+    }
+
+    void store(uint64_t hash, int depth, uint64_t count) noexcept 
+    {
+        if(!size)
+            return;
+
+        const uint64_t key = mix(hash, depth);
+        Entry& entry = entries[key & (size - 1)];
+
+        entry.count.store(count, std::memory_order_relaxed);
+        entry.check.store(key ^ count, std::memory_order_relaxed);
+    }
+
+private:
+
+    struct Entry {
+        std::atomic<uint64_t> check{0};
+        std::atomic<uint64_t> count{0};
+    };
+
+    static uint64_t mix(uint64_t hash, int depth) noexcept {
+        return hash ^ (uint64_t(depth) * 0x9E3779B97F4A7C15ULL);
+    }
+
+private:
+
+    std::unique_ptr<Entry[]> entries;
+    size_t size;
+
+};
+
+struct Settings {
+    int depth = 6;
+    std::string fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t hashMB = 64;
+    bool bulk = true;
+    bool copyMake = false;
+    bool suite = false;
+};
+
+template<typename Position>
+uint64_t Perft(Position& pos, int depth, PerftHash& hash, bool bulk)
+{
+    if(depth == 0)
+        return 1;
+
+    if(bulk && depth == 1) {
+        pos.UpdateAttacks();
+        return Logic::MoveList::count<Logic::MoveGenType::All>(pos);
+    }
+
+    uint64_t nodes;
+    if(depth > 1 && hash.probe(pos.GetHash(), depth, nodes))
+        return nodes;
+
+    Logic::MoveGenerator<Logic::MoveGenType::All> gen(pos);
+
+    nodes = 0;
+    for(Logic::Move move : gen.moves) {
+        pos.DoMove(move);
+        nodes += Perft(pos, depth - 1, hash, bulk);
+        pos.UndoMove();
+    }
+
+    if(depth > 1)
+        hash.store(pos.GetHash(), depth, nodes);
+
+    return nodes;
+}
+
+struct Divide {
+    Logic::Move move;
+    uint64_t nodes;
+};
+
+template<typename Position>
+std::vector<Divide> RunDivide(const Settings& settings, PerftHash& hash)
+{
+    Position root(settings.fen);
+    Logic::MoveGenerator<Logic::MoveGenType::All> gen(root);
+
+    std::vector<Divide> result;
+    for(Logic::Move move : gen.moves)
+        result.push_back({move, 0});
+
+    if(settings.depth <= 1) {
+        for(Divide& d : result)
+            d.nodes = settings.depth == 1;
+        return result;
+    }
+
+    std::atomic<size_t> next = 0;
+    auto work = [&]() {
+        // позицию нельзя копировать (история в своем массиве), у каждого потока своя из FEN
+        Position pos(settings.fen);
+        for(size_t i; (i = next.fetch_add(1)) < result.size(); ) {
+            pos.DoMove(result[i].move);
+            result[i].nodes = Perft(pos, settings.depth - 1, hash, settings.bulk);
+            pos.UndoMove();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for(int t = 1; t < settings.threads; ++t)
+        pool.emplace_back(work);
+    work();
+    for(std::thread& thread : pool)
+        thread.join();
+
+    return result;
+}
+
+std::vector<Divide> RunDivide(const Settings& settings, PerftHash& hash)
+{
+    return settings.copyMake 
+        ? RunDivide<Logic::Position<Logic::CopyStorage>>(settings, hash)
+        : RunDivide<Logic::Position<Logic::StaticStorage>>(settings, hash);
+}
+
+uint64_t Total(const std::vector<Divide>& divide)
+{
+    uint64_t total = 0;
+    for(const Divide& d : divide)
+        total += d.nodes;
+    return total;
+}
+
+double Seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::max(1e-3, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+}
+
+int RunSuite(Settings settings)
+{
+    bool ok = true;
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t nodes = 0;
+
+    for(const SuiteCase& test : Suite) {
+        settings.fen = test.fen;
+        settings.depth = test.depth;
+
+        // таблица новая на каждую позицию: ошибка в одной не должна маскироваться записями другой
+        PerftHash hash(settings.hashMB);
+        const auto caseStart = std::chrono::steady_clock::now();
+        const uint64_t actual = Total(RunDivide(settings, hash));
+        nodes += actual;
+
+        ok &= actual == test.expected;
+        std::cout << std::format(
+            "{:<4} depth {} {:>12} {:>8.2f}s  {}\n", 
+            actual == test.expected ? "ok" : "FAIL", test.depth, actual, Seconds(caseStart), test.fen
+        );
+    }
+
+    const double sec = Seconds(start);
+    std::cout << std::format("\n{} nodes in {:.2f}s, {:.1f} Mnps\n", nodes, sec, nodes / sec / 1e6);
+    return ok ? 0 : 1;
+}
+
+Settings Parse(int argc, char* argv[])
+{
+    Settings settings;
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if(arg == "--depth" && hasValue)            settings.depth = std::stoi(argv[++i]);
+        else if(arg == "--fen" && hasValue)         settings.fen = argv[++i];
+        else if(arg == "--threads" && hasValue)     settings.threads = std::max(1, std::stoi(argv[++i]));
+        else if(arg == "--hash" && hasValue)        settings.hashMB = std::stoul(argv[++i]);
+        else if(arg == "--no-bulk")                 settings.bulk = false;
+        else if(arg == "--copy-make")               settings.copyMake = true;
+        else if(arg == "--suite")                   settings.suite = true;
+        else throw std::invalid_argument(std::format("unknown argument {}", arg));
+    }
+    return settings;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Settings settings;
+    try {
+        settings = Parse(argc, argv);
+    } catch(const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 2;
+    }
+
+    std::cout << std::format(
+        "threads {}, hash {} MB, bulk {}, {}\n\n", settings.threads, settings.hashMB, 
+        settings.bulk ? "on" : "off", settings.copyMake ? "copy-make" : "make/unmake"
+    );
+
+    if(settings.suite)
+        return RunSuite(settings);
+
+    PerftHash hash(settings.hashMB);
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<Divide> divide = RunDivide(settings, hash);
+    const double sec = Seconds(start);
+
+    std::ranges::sort(divide, {}, [](const Divide& d) {return d.move.to_string();});
+    for(const Divide& d : divide)
+        std::cout << std::format("{}: {}\n", d.move.to_string(), d.nodes);
+
+    const uint64_t total = Total(divide);
+    std::cout << std::format(
+        "\nmoves {}, nodes {}, {:.2f}s, {:.1f} Mnps\n", divide.size(), total, sec, total / sec / 1e6
+    );
+}
@@ -0,0 +1,107 @@
+#include "engine/search.hpp"
+#include "logic/position.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+Масштабирование Lazy SMP: каждая позиция ищется до фиксированной глубины
+с 1, 2, 4, 8, 16 потоками, печатается время до глубины и nodes/sec.
+1st-cut - доля отсечений по beta, которые дал первый же ход (качество сортировки).
+usage: search_bench [depth] [max threads]
+*/
+
+using namespace Core;
+
+namespace
+{
+
+const std::vector<std::string> Positions = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP1B1PPP/R2QKB1R w KQ - 0 8",
+    "r2q1rk1/ppp2ppp/2n1bn2/2b1p3/3pP3/3P1NPP/PPP1NPB1/R1BQ1RK1 b - - 0 9",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+};
+
+struct Sample {
+    long long nodes = 0;
+    long long cutoffs = 0;
+    long long firstMoveCutoffs = 0;
+    std::chrono::milliseconds time{0};
+};
+
+Sample Measure(const std::string& fen, int depth, int threads)
+{
+    Logic::PositionDM pos(fen);
+
+    std::promise<Engine::Search::Info> done;
+    std::future<Engine::Search::Info> result = done.get_future();
+
+    Engine::Search::Options options;
+    options.timeSec = 3600;
+    options.ttSizeMB = 64;
+    options.maxDepth = depth;
+    options.threads = threads;
+    options.onMove = [&done](Engine::Search::Info info) {done.set_value(info);};
+
+    Engine::Search search;
+    search.Init(options);
+    search.SetPosition(pos);
+    search.Launch();
+
+    const auto start = std::chrono::steady_clock::now();
+    search.Think();
+    const Engine::Search::Info info = result.get();
+    const auto end = std::chrono::steady_clock::now();
+
+    return {
+        info.nodes, 
+        info.cutoffs,
+        info.first_move_cutoffs,
+        std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+    };
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const int depth = argc > 1 ? std::stoi(argv[1]) : 6;
+    const int maxThreads = argc > 2 ? std::stoi(argv[2]) : 16;
+
+    std::cout << std::format(
+        "{:>8} {:>14} {:>14} {:>12} {:>8} {:>8}\n", 
+        "threads", "nodes", "time-to-depth", "nps", "speedup", "1st-cut"
+    );
+
+    double baseTime = 0;
+
+    for(int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        Sample total;
+        for(const std::string& fen : Positions) {
+            Sample s = Measure(fen, depth, threads);
+            total.nodes += s.nodes;
+            total.cutoffs += s.cutoffs;
+            total.firstMoveCutoffs += s.firstMoveCutoffs;
+            total.time += s.time;
+        }
+
+        const double sec = std::max<double>(total.time.count(), 1) / 1000;
+        if(threads == 1)
+            baseTime = sec;
+
+        std::cout << std::format(
+            "{:>8} {:>14} {:>12}ms {:>12.0f} {:>7.2f}x {:>7.1f}%\n", 
+            threads, total.nodes, total.time.count(), total.nodes / sec, baseTime / sec,
+            100.0 * total.firstMoveCutoffs / std::max(1LL, total.cutoffs)
+        );
+    }
+}
@@ -0,0 +1,175 @@
+#include "engine/search.hpp"
+#include "logic/movelist.hpp"
+#include "logic/position.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <format>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+A/B самоигра: движок со всеми сокращениями перебора (A) против движка
+без LMR и null move (B) с одинаковым временем на ход.
+Каждая позиция играется дважды со сменой цветов. Партия признается
+законченной при мате, ничьей по правилам, лимите полуходов или когда
+оба движка подряд оценивают позицию больше чем в AdjudicateScore в одну сторону.
+usage: selfplay [sec per move] [max plies]
+*/
+
+using namespace Core;
+
+namespace
+{
+
+const std::vector<std::string> Openings = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+    "rnbqkb1r/pp2pppp/3p1n2/8/3NP3/8/PPP2PPP/RNBQKB1R w KQkq - 1 5",
+    "rnbqkbnr/pp2pppp/2p5/3p4/2PP4/8/PP2PPPP/RNBQKBNR w KQkq - 0 3",
+    "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP1B1PPP/R2QKB1R w KQ - 0 8",
+    "r2q1rk1/ppp2ppp/2n1bn2/2b1p3/3pP3/3P1NPP/PPP1NPB1/R1BQ1RK1 b - - 0 9",
+};
+
+constexpr int AdjudicateScore = 800;
+
+enum class Outcome {WhiteWins, BlackWins, Draw};
+
+class Player
+{
+public:
+
+    Player(const Engine::Search::Options& base, bool pruning)
+    {
+        Engine::Search::Options options = base;
+        options.lmr = pruning;
+        options.nullMove = pruning;
+        options.onMove = [this](Engine::Search::Info info) {pending.set_value(info);};
+
+        search.Init(options);
+        search.Launch();
+    }
+
+    Engine::Search::Info Think(const Logic::PositionDM& pos)
+    {
+        pending = {};
+        std::future<Engine::Search::Info> result = pending.get_future();
+
+        search.SetPosition(pos);
+        search.Think();
+
+        Engine::Search::Info info = result.get();
+        depthSum += info.depth;
+        moves++;
+        return info;
+    }
+
+    void NewGame() {search.NewGame();}
+    double AverageDepth() const {return moves ? double(depthSum) / moves : 0;}
+
+private:
+
+    Engine::Search search;
+    std::promise<Engine::Search::Info> pending;
+    long long depthSum = 0;
+    long long moves = 0;
+
+};
+
+Outcome Play(const std::string& fen, Player& white, Player& black, int maxPlies)
+{
+    Logic::PositionDM pos(fen);
+    white.NewGame();
+    black.NewGame();
+
+    int lastWhiteEval = 0;
+
+    for(int ply = 0; ply < maxPlies; ++ply)
+    {
+        const bool whiteToMove = pos.GetSide() == Logic::WHITE;
+        Player& player = whiteToMove ? white : black;
+
+        const Engine::Search::Info info = player.Think(pos);
+        const int whiteEval = whiteToMove ? info.eval : -info.eval;
+
+        if(
+            ply && std::abs(whiteEval) >= AdjudicateScore &&
+            std::abs(lastWhiteEval) >= AdjudicateScore &&
+            (whiteEval > 0) == (lastWhiteEval > 0)
+        ) {
+            return whiteEval > 0 ? Outcome::WhiteWins : Outcome::BlackWins;
+        }
+        lastWhiteEval = whiteEval;
+
+        pos.DoMove(info.bestMove);
+
+        Logic::MoveGenerator<Logic::MoveGenType::All> gen(pos);
+        if(gen.moves.empty()) {
+            if(!pos.IsCheck())
+                return Outcome::Draw;
+            return pos.GetSide() == Logic::WHITE ? Outcome::BlackWins : Outcome::WhiteWins;
+        }
+
+        if(pos.IsDraw())
+            return Outcome::Draw;
+    }
+
+    return Outcome::Draw;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Engine::Search::Options base;
+    base.timeSec = argc > 1 ? std::stoi(argv[1]) : 1;
+    base.ttSizeMB = 64;
+    base.maxDepth = Logic::MAX_PLY;
+
+    const int maxPlies = argc > 2 ? std::stoi(argv[2]) : 200;
+
+    Player a(base, true);
+    Player b(base, false);
+
+    int wins = 0, draws = 0, losses = 0;
+
+    for(const std::string& fen : Openings)
+    {
+        for(bool aIsWhite : {true, false})
+        {
+            const Outcome outcome = aIsWhite
+                ? Play(fen, a, b, maxPlies)
+                : Play(fen, b, a, maxPlies);
+
+            const char* result = "1/2-1/2";
+            if(outcome == Outcome::WhiteWins) {
+                result = "1-0";
+                aIsWhite ? ++wins : ++losses;
+            } else if(outcome == Outcome::BlackWins) {
+                result = "0-1";
+                aIsWhite ? ++losses : ++wins;
+            } else {
+                ++draws;
+            }
+
+            std::cout << std::format("{:<8} {:<8} {:<8} {}\n", aIsWhite ? "A" : "B", aIsWhite ? "B" : "A", result, fen);
+        }
+    }
+
+    const int games = wins + draws + losses;
+    const double score = (wins + 0.5 * draws) / games;
+    const double elo = score <= 0 || score >= 1
+        ? std::copysign(INFINITY, score - 0.5)
+        : -400 * std::log10(1 / score - 1);
+
+    std::cout << std::format(
+        "\nA (lmr + null move) vs B (none): +{} ={} -{}  score {:.1f}%  elo {:+.0f}\n",
+        wins, draws, losses, score * 100, elo
+    );
+    std::cout << std::format(
+        "average depth per move: A {:.2f}, B {:.2f}\n",
+        a.AverageDepth(), b.AverageDepth()
+    );
+}
@@ -0,0 +1,147 @@
+#include "engine/tt.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+/*
+Время старта таблицы транспозиций: выделение (resize), повторная
+очистка (clear) и случайные probe с подсчетом промахов dTLB.
+Счетчик dTLB читается через perf_event_open, если ядро это разрешает
+(kernel.perf_event_paranoid), иначе печатается "n/a".
+usage: tt_bench [size mb]...
+*/
+
+using namespace Core::Engine;
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+class TlbMissCounter 
+{
+public:
+
+    TlbMissCounter() 
+    {
+#ifdef __linux__
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.size = sizeof(attr);
+        attr.config = 
+            PERF_COUNT_HW_CACHE_DTLB | 
+            PERF_COUNT_HW_CACHE_OP_READ << 8 | 
+            PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+
+    ~TlbMissCounter() 
+    {
+#ifdef __linux__
+        if(fd >= 0) close(fd);
+#endif
+    }
+
+    void Start() 
+    {
+#ifdef __linux__
+        if(fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    std::optional<uint64_t> Stop() 
+    {
+#ifdef __linux__
+        uint64_t count;
+        if(fd < 0) return std::nullopt;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if(read(fd, &count, sizeof(count)) == sizeof(count))
+            return count;
+#endif
+        return std::nullopt;
+    }
+
+private:
+
+    int fd = -1;
+
+};
+
+double Ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<size_t> sizes;
+    for(int i = 1; i < argc; ++i)
+        sizes.push_back(std::stoull(argv[i]));
+    if(sizes.empty())
+        sizes = {16, 256, 1024};
+
+    constexpr int Probes = 10'000'000;
+
+    std::cout << std::format(
+        "{:>8} {:>12} {:>12} {:>14} {:>16}\n", 
+        "size mb", "resize ms", "clear ms", "probes/sec", "dTLB miss/probe"
+    );
+
+    for(size_t mb : sizes)
+    {
+        Transposition tt;
+
+        auto start = Clock::now();
+        tt.resize(mb);
+        const double resizeMs = Ms(start);
+
+        start = Clock::now();
+        tt.clear();
+        const double clearMs = Ms(start);
+
+        std::mt19937_64 gen(42);
+        for(int i = 0; i < Probes; ++i) {
+            const uint64_t key = gen();
+            tt.store(key, int16_t(key), {}, uint8_t(key & 31), EntryType::Exact);
+        }
+
+        TlbMissCounter tlb;
+        long long hits = 0;
+
+        start = Clock::now();
+        tlb.Start();
+        for(int i = 0; i < Probes; ++i)
+            hits += tt.probe(gen(), 0, -30000, 30000).score.has_value();
+        const std::optional<uint64_t> misses = tlb.Stop();
+        const double probeMs = Ms(start);
+
+        std::cout << std::format(
+            "{:>8} {:>12.1f} {:>12.1f} {:>14.0f} {:>16}\n", 
+            mb, resizeMs, clearMs, Probes / probeMs * 1000,
+            misses ? std::format("{:.3f}", double(*misses) / Probes) : "n/a"
+        );
+
+        if(hits < 0) // не дает компилятору выбросить probe
+            return 1;
+    }
+}
@@ -1,7 +1,9 @@
 #include "eval.hpp"
 #include "logic/defs.hpp"
 #include "logic/square.hpp"
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
 
 namespace Core::Engine
 {
@@ -166,6 +168,16 @@ int* eg_pesto_table[PIECE_COUNT] =
 };
 
 int gamephaseInc[PIECE_COUNT] = {0,4,0,1,1,2};
+
+// проходная, перед которой стоит фигура, и близость королей к полю перед проходной (эндшпиль)
+constexpr int BlockedPasserEg = -4;
+constexpr int PasserOppKingEg = 3;
+constexpr int PasserOwnKingEg = -1;
+
+int Distance(Square a, Square b)
+{
+    return std::max(std::abs(a.rank() - b.rank()), std::abs(a.file() - b.file()));
+}
 int mg_table[COLOR_COUNT][PIECE_COUNT][SQUARE_COUNT];
 int eg_table[COLOR_COUNT][PIECE_COUNT][SQUARE_COUNT];
 
@@ -187,7 +199,8 @@ void Evaluation::Setup()
 
 void Evaluation::Init(const PositionFM& pos)
 {
-    Data& _cur = *cur;
+    cur = frames.get();
+    Data& _cur = cur->data;
 
     _cur.game_phase = 0;
     _cur.mg[WHITE] = 0;
@@ -198,19 +211,25 @@ void Evaluation::Init(const PositionFM& pos)
     for(Square sqr = Square::Start(); sqr <= Square::End(); ++sqr) {
         Piece p = pos.GetPiece(sqr);
         Color c = pos.GetPieceColor(sqr);
-        if(p.isValid()) 
-            addPiece(c, p, sqr);
+        // без addPiece: он копит Delta только для одного хода
+        if(p.isValid()) {
+            _cur.mg[c] += mg_table[c][p][sqr];
+            _cur.eg[c] += eg_table[c][p][sqr];
+            _cur.game_phase += gamephaseInc[p];
+        }
     }
 
+    if(network)
+        network->Refresh(cur->accumulator, pos);
+
     this->pos = &pos;
 }
 
 void Evaluation::Update(Move move) 
 {
     cur++;
-    assert(cur);
-    *cur = *(cur - 1);
-    Data& _cur = *cur;
+    cur->data = (cur - 1)->data;
+    delta = {};
 
     const Color opp = pos->GetSide();
     const Color us = opp.opp();
@@ -235,13 +254,9 @@ void Evaluation::Update(Move move)
     case R_PROMOTION_MF:
     case K_PROMOTION_MF:
     case B_PROMOTION_MF:
-    {
-        const Piece p = pos->GetPiece(targ);
-        _cur.mg[us] += mg_table[us][p][targ] - mg_table[us][PAWN][from];
-        _cur.eg[us] += eg_table[us][p][targ] - eg_table[us][PAWN][from];
-        _cur.game_phase += gamephaseInc[p] - gamephaseInc[PAWN];
+        removePiece(us, PAWN, from);
+        addPiece(us, pos->GetPiece(targ), targ);
         break;
-    }
     default:
     {
         movePiece(us, pos->GetPiece(targ), from, targ);
@@ -249,22 +264,36 @@ void Evaluation::Update(Move move)
     }
     
     }
+
+    if(network)
+        network->Update(cur->accumulator, (cur - 1)->accumulator, delta);
 }
 
 void Evaluation::Rollback()
 {
+    assert(cur > frames.get());
     cur--;
-    assert(cur);
 }
 
 int Evaluation::Score() const
 {
-    const Data _cur = *cur;
+    if(network)
+        return network->Evaluate(cur->accumulator, pos->GetSide());
+
+    const Data _cur = cur->data;
     const Color side = pos->GetSide();
     const Color opp = side.opp();
 
     int mg_score = _cur.mg[side] - _cur.mg[opp];
     int eg_score = _cur.eg[side] - _cur.eg[opp];
+
+    if(pawnStructure) {
+        int mg, eg;
+        structure(mg, eg);
+        const int sign = side.is(WHITE) ? 1 : -1;
+        mg_score += sign * mg;
+        eg_score += sign * eg;
+    }
     
     int mg_phase = (_cur.game_phase > 24) ? 24 : _cur.game_phase;
     int eg_phase = 24 - mg_phase;
@@ -272,27 +301,59 @@ int Evaluation::Score() const
     return (mg_score * mg_phase + eg_score * eg_phase) / 24;
 }
 
+void Evaluation::structure(int& mg, int& eg) const
+{
+    const PawnEntry& entry = pawns.Probe(*pos);
+    mg = entry.mg;
+    eg = entry.eg;
+
+    for(Color us : {Color(WHITE), Color(BLACK)})
+    {
+        const int sign = us.is(WHITE) ? 1 : -1;
+        const Square ourKing = pos->GetPieces(us, KING).lsb();
+        const Square theirKing = pos->GetPieces(us.opp(), KING).lsb();
+
+        for(Bitboard passed = entry.passed[us]; passed; )
+        {
+            const Square sq = passed.poplsb();
+            // проходная не стоит на последнем ряду, поле перед ней существует
+            const Square stop = us.is(WHITE) ? sq + 8 : sq - 8;
+            const int rank = us.is(WHITE) ? sq.rank() : 7 - sq.rank();
+
+            int bonus = rank * (PasserOppKingEg * Distance(theirKing, stop) + PasserOwnKingEg * Distance(ourKing, stop));
+            if(pos->GetPiece(stop).isValid())
+                bonus += rank * BlockedPasserEg;
+
+            eg += sign * bonus;
+        }
+    }
+}
+
 void Evaluation::addPiece(Color side, Piece piece, Square sqr)
 {
-    Data& _cur = *cur;
+    Data& _cur = cur->data;
     _cur.mg[side] += mg_table[side][piece][sqr];
     _cur.eg[side] += eg_table[side][piece][sqr];
     _cur.game_phase += gamephaseInc[piece];
+    delta.add(side, piece, sqr);
 }
 
 void Evaluation::removePiece(Color side, Piece piece, Square from)
 {
-    Data& _cur = *cur;
+    Data& _cur = cur->data;
     _cur.mg[side] -= mg_table[side][piece][from];
     _cur.eg[side] -= eg_table[side][piece][from];
     _cur.game_phase -= gamephaseInc[piece];
+    delta.remove(side, piece, from);
 }
 
 void Evaluation::movePiece(Color side, Piece piece, Square from, Square targ)
 {
-    Data& _cur = *cur;
+    Data& _cur = cur->data;
     _cur.mg[side] += mg_table[side][piece][targ] - mg_table[side][piece][from];
     _cur.eg[side] += eg_table[side][piece][targ] - eg_table[side][piece][from];
+    delta.remove(side, piece, from);
+    delta.add(side, piece, targ);
 }
 
 void Evaluation::castle(Color side, Square kf, Square kt, Square rf, Square rt)
@@ -1,21 +1,40 @@
 #pragma once 
 
+#include "nnue.hpp"
+#include "pawns.hpp"
 #include "logic/defs.hpp"
 #include "logic/position.hpp"
 
+#include <memory>
+
 namespace Core::Engine
 {
 
+/*
+Оценка PeSTO (таблицы фигура-поле, интерполяция по фазе игры)
+плюс пешечная структура из PawnTable, либо NNUE, если передана сеть. 
+Материал и таблицы хранятся стеком по ply и обновляются инкрементально в Update/Rollback,
+стек выделяется один раз на stackSize ply.
+*/
 class Evaluation {
 public:
 
     static void Setup();
 
+    explicit Evaluation(
+        const NNUE::Network* network = nullptr, bool pawnStructure = true, 
+        int stackSize = Logic::DEFAULT_STACK_SIZE
+    ) 
+        : frames(new Frame[stackSize]), cur(frames.get()), network(network), pawnStructure(pawnStructure) {}
+
     void Init(const Logic::PositionFM&);
     void Update(Logic::Move);
     void Rollback();
     int Score() const;
 
+    const PawnTable& GetPawnTable() const noexcept {return pawns;}
+    void ResetStats() noexcept {pawns.ResetStats();}
+
 private:
 
     struct Data {
@@ -24,19 +43,34 @@ private:
         int game_phase;
     };
 
+    // все, что хранится на ply, в одной записи: аккумулятор NNUE и счетчики PeSTO
+    struct Frame {
+        NNUE::Accumulator accumulator;
+        Data data;
+    };
+
 private:
 
     void addPiece(Logic::Color side, Logic::Piece piece, Logic::Square sqr);
     void removePiece(Logic::Color side, Logic::Piece piece, Logic::Square from);
     void movePiece(Logic::Color side, Logic::Piece piece, Logic::Square from, Logic::Square targ);
     void castle(Logic::Color side, Logic::Square kf, Logic::Square kt, Logic::Square rf, Logic::Square rt);
+    // пешечные члены за белых
+    void structure(int& mg, int& eg) const;
 
 private:
 
-    Data data[Logic::MAX_HISTORY_SIZE];
-    Data* cur = data;
+    std::unique_ptr<Frame[]> frames;
+    Frame* cur;
     const Logic::PositionFM* pos;
 
+    // признаки, измененные последним Update (для аккумулятора NNUE)
+    NNUE::Delta delta;
+    const NNUE::Network* network;
+    const bool pawnStructure;
+    // кэш: Score логически не меняет оценку
+    mutable PawnTable pawns;
+
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include "evalcache.hpp"
+
+namespace Core::Engine
+{
+
+namespace
+{
+
+constexpr uint64_t EvalMask = 0xFFFF;
+
+}
+
+std::optional<int> EvalCache::Probe(uint64_t key) const noexcept
+{
+    const uint64_t entry = entries[key & (Size - 1)];
+
+    // пустая запись (0) совпадает только с ключом, у которого старшие 48 бит нулевые
+    if(!entry || ((entry ^ key) & ~EvalMask))
+        return std::nullopt;
+
+    return int16_t(entry & EvalMask);
+}
+
+void EvalCache::Store(uint64_t key, int eval) noexcept
+{
+    entries[key & (Size - 1)] = (key & ~EvalMask) | uint16_t(int16_t(eval));
+}
+
+}
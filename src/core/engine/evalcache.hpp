@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace Core::Engine
+{
+
+/*
+Кэш статической оценки по ключу позиции (GetHash), свой у каждого потока.
+Запись - одно слово: старшие 48 бит ключа и 16 бит оценки,
+так что проверка ключа и чтение оценки происходят за одно обращение к памяти.
+Оценка зависит только от позиции, поэтому кэш не чистится между поисками.
+*/
+class EvalCache {
+public:
+
+    static constexpr size_t Size = 1 << 16;
+
+    EvalCache() : entries(new uint64_t[Size]()) {}
+
+    std::optional<int> Probe(uint64_t key) const noexcept;
+    void Store(uint64_t key, int eval) noexcept;
+
+private:
+
+    std::unique_ptr<uint64_t[]> entries;
+
+};
+
+}
@@ -0,0 +1,89 @@
+#include "history.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+
+namespace Core::Engine
+{
+
+using namespace Logic;
+
+void History::Clear() noexcept
+{
+    std::memset(butterfly, 0, sizeof(butterfly));
+    std::memset(continuation, 0, sizeof(continuation));
+    std::fill_n(&counter[0][0][0], sizeof(counter) / sizeof(Move), Move{});
+}
+
+void History::Age() noexcept
+{
+    for(int16_t& entry : std::span(&butterfly[0][0][0], sizeof(butterfly) / sizeof(int16_t)))
+        entry /= 2;
+    for(int16_t& entry : std::span(&continuation[0][0][0][0][0], sizeof(continuation) / sizeof(int16_t)))
+        entry /= 2;
+}
+
+int History::Score(const PositionFM& pos, Move move) const noexcept
+{
+    const Square from = move.from();
+    const Square targ = move.targ();
+
+    int score = butterfly[pos.GetSide()][from][targ];
+    if(const Row* row = continuationRow(pos))
+        score += (*row)[pos.GetPiece(from)][targ];
+
+    return score;
+}
+
+Move History::CounterMove(const PositionFM& pos) const noexcept
+{
+    const Move last = pos.GetLastMove();
+    if(!last)
+        return Move{};
+
+    return counter[pos.GetSide()][pos.GetPiece(last.targ())][last.targ()];
+}
+
+void History::Update(const PositionFM& pos, Move move, const Move* quiets, int count, int depth) noexcept
+{
+    const Color side = pos.GetSide();
+    const int bonus = std::min(32 * depth * depth, 4096);
+
+    Row* row = continuationRow(pos);
+
+    auto apply = [&](Move m, int value) {
+        gravity(butterfly[side][m.from()][m.targ()], value);
+        if(row)
+            gravity((*row)[pos.GetPiece(m.from())][m.targ()], value);
+    };
+
+    apply(move, bonus);
+    for(int i = 0; i < count; ++i)
+        apply(quiets[i], -bonus);
+
+    if(const Move last = pos.GetLastMove())
+        counter[side][pos.GetPiece(last.targ())][last.targ()] = move;
+}
+
+void History::gravity(int16_t& entry, int bonus) noexcept
+{
+    entry += bonus - entry * std::abs(bonus) / Max;
+}
+
+History::Row* History::continuationRow(const PositionFM& pos) noexcept
+{
+    const Move last = pos.GetLastMove();
+    if(!last)
+        return nullptr;
+
+    return &continuation[pos.GetSide()][pos.GetPiece(last.targ())][last.targ()];
+}
+
+const History::Row* History::continuationRow(const PositionFM& pos) const noexcept
+{
+    return const_cast<History*>(this)->continuationRow(pos);
+}
+
+}
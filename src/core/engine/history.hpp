@@ -0,0 +1,59 @@
+#pragma once
+
+#include "logic/defs.hpp"
+#include "logic/move.hpp"
+#include "logic/position.hpp"
+
+#include <cstdint>
+
+namespace Core::Engine
+{
+
+/*
+Статистика тихих ходов для сортировки, своя у каждого потока поиска:
+butterfly    - [сторона][откуда][куда],
+continuation - [сторона][фигура и поле прошлого хода][фигура][куда],
+countermove  - лучший ответ на прошлый ход соперника [сторона][фигура][куда].
+Обновление с "гравитацией": чем ближе значение к Max, тем меньше прибавка,
+поэтому int16 не переполняется, а старая статистика постепенно вытесняется.
+*/
+class History {
+public:
+
+    static constexpr int Max = 16384;
+
+    History() noexcept {Clear();}
+
+    // новая партия
+    void Clear() noexcept;
+    // новый поиск: статистика прошлых ходов ослабляется вдвое
+    void Age() noexcept;
+
+    // оценка тихого хода в текущей позиции (до DoMove)
+    int Score(const Logic::PositionFM&, Logic::Move) const noexcept;
+    // ответ, который раньше опровергал прошлый ход соперника
+    Logic::Move CounterMove(const Logic::PositionFM&) const noexcept;
+
+    // тихий move дал отсечение, quiets - тихие ходы, просмотренные до него
+    void Update(const Logic::PositionFM&, Logic::Move move, const Logic::Move* quiets, int count, int depth) noexcept;
+
+private:
+
+    using Row = int16_t[Logic::PIECE_COUNT][Logic::SQUARE_COUNT];
+
+private:
+
+    static void gravity(int16_t& entry, int bonus) noexcept;
+    // строка continuation для прошлого хода, nullptr у корня и после null move
+    Row* continuationRow(const Logic::PositionFM&) noexcept;
+    const Row* continuationRow(const Logic::PositionFM&) const noexcept;
+
+private:
+
+    int16_t butterfly[Logic::COLOR_COUNT][Logic::SQUARE_COUNT][Logic::SQUARE_COUNT];
+    Row continuation[Logic::COLOR_COUNT][Logic::PIECE_COUNT][Logic::SQUARE_COUNT];
+    Logic::Move counter[Logic::COLOR_COUNT][Logic::PIECE_COUNT][Logic::SQUARE_COUNT];
+
+};
+
+}
@@ -0,0 +1,336 @@
+#include "nnue.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <new>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+    #include <immintrin.h>
+#endif
+
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace Core::Engine::NNUE
+{
+
+using namespace Logic;
+
+namespace
+{
+
+/*
+Файл сети: заголовок на FileHeaderBytes, затем Weights как есть.
+Заголовок занимает целую строку кэша, чтобы веса в отображенном файле
+оставались выровненными для векторных загрузок.
+*/
+constexpr char FileMagic[8] = "A101NN";
+constexpr uint32_t FileVersion = 1;
+constexpr size_t FileHeaderBytes = 64;
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t features;
+    uint32_t hidden;
+
+    bool valid(size_t bytes) const noexcept {
+        return
+            std::memcmp(magic, FileMagic, sizeof(FileMagic)) == 0 &&
+            version == FileVersion &&
+            features == FeatureCount &&
+            hidden == HiddenSize &&
+            bytes == FileHeaderBytes + sizeof(Weights);
+    }
+};
+static_assert(sizeof(FileHeader) <= FileHeaderBytes);
+
+/*
+Векторные примитивы: int16 сложение/вычитание для аккумулятора,
+clipped ReLU и умножение с попарным сложением в int32 для выхода.
+Набор инструкций выбирается при компиляции (-march=native),
+скалярная версия работает по одному элементу.
+*/
+#if defined(__AVX2__)
+
+using Vec = __m256i;
+using Vec32 = __m256i;
+constexpr int Lanes = 16;
+constexpr const char* KernelName = "avx2";
+
+inline Vec LoadVec(const int16_t* p) {return _mm256_load_si256(reinterpret_cast<const Vec*>(p));}
+inline void StoreVec(int16_t* p, Vec v) {_mm256_store_si256(reinterpret_cast<Vec*>(p), v);}
+inline Vec Add(Vec a, Vec b) {return _mm256_add_epi16(a, b);}
+inline Vec Sub(Vec a, Vec b) {return _mm256_sub_epi16(a, b);}
+inline Vec Clamp(Vec v) {return _mm256_min_epi16(_mm256_max_epi16(v, _mm256_setzero_si256()), _mm256_set1_epi16(QA));}
+inline Vec32 Zero32() {return _mm256_setzero_si256();}
+inline Vec32 MulAdd(Vec32 sum, Vec a, Vec b) {return _mm256_add_epi32(sum, _mm256_madd_epi16(a, b));}
+inline int Sum(Vec32 v)
+{
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_hadd_epi32(s, s);
+    s = _mm_hadd_epi32(s, s);
+    return _mm_cvtsi128_si32(s);
+}
+
+#elif defined(__SSE4_1__)
+
+using Vec = __m128i;
+using Vec32 = __m128i;
+constexpr int Lanes = 8;
+constexpr const char* KernelName = "sse4.1";
+
+inline Vec LoadVec(const int16_t* p) {return _mm_load_si128(reinterpret_cast<const Vec*>(p));}
+inline void StoreVec(int16_t* p, Vec v) {_mm_store_si128(reinterpret_cast<Vec*>(p), v);}
+inline Vec Add(Vec a, Vec b) {return _mm_add_epi16(a, b);}
+inline Vec Sub(Vec a, Vec b) {return _mm_sub_epi16(a, b);}
+inline Vec Clamp(Vec v) {return _mm_min_epi16(_mm_max_epi16(v, _mm_setzero_si128()), _mm_set1_epi16(QA));}
+inline Vec32 Zero32() {return _mm_setzero_si128();}
+inline Vec32 MulAdd(Vec32 sum, Vec a, Vec b) {return _mm_add_epi32(sum, _mm_madd_epi16(a, b));}
+inline int Sum(Vec32 v)
+{
+    v = _mm_hadd_epi32(v, v);
+    v = _mm_hadd_epi32(v, v);
+    return _mm_cvtsi128_si32(v);
+}
+
+#else
+
+using Vec = int16_t;
+using Vec32 = int32_t;
+constexpr int Lanes = 1;
+constexpr const char* KernelName = "scalar";
+
+inline Vec LoadVec(const int16_t* p) {return *p;}
+inline void StoreVec(int16_t* p, Vec v) {*p = v;}
+inline Vec Add(Vec a, Vec b) {return int16_t(a + b);}
+inline Vec Sub(Vec a, Vec b) {return int16_t(a - b);}
+inline Vec Clamp(Vec v) {return std::clamp<int16_t>(v, 0, QA);}
+inline Vec32 Zero32() {return 0;}
+inline Vec32 MulAdd(Vec32 sum, Vec a, Vec b) {return sum + int32_t(a) * b;}
+inline int Sum(Vec32 v) {return v;}
+
+#endif
+
+static_assert(HiddenSize % Lanes == 0);
+
+// оценка нейросети не должна попадать в диапазон матов
+constexpr int MaxScore = INF - 2 * MAX_PLY;
+
+int Index(Color perspective, const Delta::Feature& f) noexcept
+{
+    const int relative = int(f.color) == int(perspective) ? 0 : 1;
+    const int square = int(perspective) == WHITE ? int(f.square) : int(f.square) ^ 56;
+    return (relative * PIECE_COUNT + int(f.piece)) * SQUARE_COUNT + square;
+}
+
+// dst = src + сумма строк add - сумма строк sub
+void AddSub(int16_t* dst, const int16_t* src, const int16_t* const* add, int addCount, const int16_t* const* sub, int subCount) noexcept
+{
+    for(int i = 0; i < HiddenSize; i += Lanes) {
+        Vec v = LoadVec(src + i);
+        for(int a = 0; a < addCount; ++a)
+            v = Add(v, LoadVec(add[a] + i));
+        for(int s = 0; s < subCount; ++s)
+            v = Sub(v, LoadVec(sub[s] + i));
+        StoreVec(dst + i, v);
+    }
+}
+
+uint64_t SplitMix(uint64_t& state) noexcept
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+}
+
+Network::Network() : weights(new Weights{}) {}
+
+Network::~Network()
+{
+    release();
+}
+
+void Network::release() noexcept
+{
+#ifdef __linux__
+    if(mapped) {
+        munmap(mapped, mappedBytes);
+        mapped = nullptr;
+        mappedBytes = 0;
+        weights = nullptr;
+        return;
+    }
+#endif
+    delete weights;
+    weights = nullptr;
+}
+
+bool Network::Load(const std::string& path)
+{
+#ifdef __linux__
+    const int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || size_t(st.st_size) <= FileHeaderBytes) {
+        close(fd);
+        return false;
+    }
+
+    const size_t bytes = st.st_size;
+
+    // только чтение: страницы с весами делятся между процессами через page cache
+    void* mem = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mem == MAP_FAILED)
+        return false;
+
+    if(!static_cast<const FileHeader*>(mem)->valid(bytes)) {
+        munmap(mem, bytes);
+        return false;
+    }
+
+    release();
+
+    mapped = mem;
+    mappedBytes = bytes;
+    weights = reinterpret_cast<Weights*>(static_cast<char*>(mem) + FileHeaderBytes);
+
+    return true;
+#else
+    std::ifstream in(path, std::ios::binary);
+    if(!in)
+        return false;
+
+    char page[FileHeaderBytes];
+    FileHeader header;
+    if(!in.read(page, FileHeaderBytes))
+        return false;
+    std::memcpy(&header, page, sizeof(header));
+
+    in.seekg(0, std::ios::end);
+    if(!header.valid(size_t(in.tellg())))
+        return false;
+    in.seekg(FileHeaderBytes);
+
+    Weights* loaded = new Weights;
+    if(!in.read(reinterpret_cast<char*>(loaded), sizeof(Weights))) {
+        delete loaded;
+        return false;
+    }
+
+    release();
+    weights = loaded;
+
+    return true;
+#endif
+}
+
+bool Network::Save(const std::string& path) const
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if(!out)
+        return false;
+
+    char page[FileHeaderBytes] = {};
+    FileHeader header{};
+    std::memcpy(header.magic, FileMagic, sizeof(FileMagic));
+    header.version = FileVersion;
+    header.features = FeatureCount;
+    header.hidden = HiddenSize;
+    std::memcpy(page, &header, sizeof(header));
+
+    out.write(page, FileHeaderBytes);
+    out.write(reinterpret_cast<const char*>(weights), sizeof(Weights));
+
+    return bool(out);
+}
+
+void Network::Randomize(uint64_t seed)
+{
+    if(mapped) {
+        release();
+        weights = new Weights{};
+    }
+
+    auto random = [&seed](int range) {
+        return int16_t(int(SplitMix(seed) % (2 * range + 1)) - range);
+    };
+
+    for(auto& row : weights->feature)
+        for(int16_t& w : row)
+            w = random(32);
+    for(int16_t& b : weights->featureBias)
+        b = random(64) + 64;
+    for(auto& row : weights->output)
+        for(int16_t& w : row)
+            w = random(16);
+    weights->outputBias = 0;
+}
+
+void Network::Refresh(Accumulator& acc, const PositionFM& pos) const noexcept
+{
+    for(Color perspective : {Color(WHITE), Color(BLACK)})
+    {
+        const int16_t* rows[SQUARE_COUNT];
+        int count = 0;
+
+        for(Square sqr = Square::Start(); sqr <= Square::End(); ++sqr) {
+            const Piece piece = pos.GetPiece(sqr);
+            if(piece.isValid())
+                rows[count++] = weights->feature[Index(perspective, {pos.GetPieceColor(sqr), piece, sqr})];
+        }
+
+        AddSub(acc.values[perspective], weights->featureBias, rows, count, nullptr, 0);
+    }
+}
+
+void Network::Update(Accumulator& dst, const Accumulator& src, const Delta& delta) const noexcept
+{
+    for(Color perspective : {Color(WHITE), Color(BLACK)})
+    {
+        const int16_t* add[2];
+        const int16_t* sub[2];
+
+        for(int i = 0; i < delta.addedCount; ++i)
+            add[i] = weights->feature[Index(perspective, delta.added[i])];
+        for(int i = 0; i < delta.removedCount; ++i)
+            sub[i] = weights->feature[Index(perspective, delta.removed[i])];
+
+        AddSub(dst.values[perspective], src.values[perspective], add, delta.addedCount, sub, delta.removedCount);
+    }
+}
+
+int Network::Evaluate(const Accumulator& acc, Color side) const noexcept
+{
+    const int16_t* us = acc.values[side];
+    const int16_t* them = acc.values[side.opp()];
+
+    Vec32 sum = Zero32();
+    for(int i = 0; i < HiddenSize; i += Lanes) {
+        sum = MulAdd(sum, Clamp(LoadVec(us + i)), LoadVec(weights->output[0] + i));
+        sum = MulAdd(sum, Clamp(LoadVec(them + i)), LoadVec(weights->output[1] + i));
+    }
+
+    // смещение выхода хранится в масштабе весов выхода (QB)
+    const int64_t output = Sum(sum) + weights->outputBias * QA;
+    return int(std::clamp<int64_t>(output * OutputScale / (QA * QB), -MaxScore, MaxScore));
+}
+
+const char* Network::Kernel() noexcept
+{
+    return KernelName;
+}
+
+}
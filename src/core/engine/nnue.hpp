@@ -0,0 +1,104 @@
+#pragma once
+
+#include "logic/defs.hpp"
+#include "logic/position.hpp"
+#include "logic/square.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Core::Engine::NNUE
+{
+
+/*
+Сеть 768 -> 2 x HiddenSize -> 1.
+Признаки - (цвет относительно перспективы, фигура, поле), для черных поле отражается.
+Первый слой (аккумулятор) считается для обеих перспектив и обновляется
+инкрементально: ход меняет 2-4 признака, то есть 2-4 строки весов.
+Выход - clipped ReLU аккумуляторов стороны на ходу и соперника,
+скалярное произведение с весами выхода.
+*/
+constexpr int FeatureCount = Logic::COLOR_COUNT * Logic::PIECE_COUNT * Logic::SQUARE_COUNT;
+constexpr int HiddenSize = 256;
+
+// квантование: аккумулятор в масштабе QA, веса выхода в масштабе QB
+constexpr int QA = 255;
+constexpr int QB = 64;
+constexpr int OutputScale = 400;
+
+struct alignas(64) Accumulator {
+    int16_t values[Logic::COLOR_COUNT][HiddenSize];
+};
+
+// изменение признаков за один ход
+struct Delta {
+
+    struct Feature {
+        Logic::Color color;
+        Logic::Piece piece;
+        Logic::Square square;
+    };
+
+    void add(Logic::Color color, Logic::Piece piece, Logic::Square square) noexcept {
+        added[addedCount++] = {color, piece, square};
+    }
+    void remove(Logic::Color color, Logic::Piece piece, Logic::Square square) noexcept {
+        removed[removedCount++] = {color, piece, square};
+    }
+
+    Feature added[2];
+    Feature removed[2];
+    int addedCount = 0;
+    int removedCount = 0;
+
+};
+
+struct alignas(64) Weights {
+    int16_t feature[FeatureCount][HiddenSize];
+    int16_t featureBias[HiddenSize];
+    // [0] - для аккумулятора стороны на ходу, [1] - соперника
+    int16_t output[Logic::COLOR_COUNT][HiddenSize];
+    int16_t outputBias;
+};
+
+/*
+Веса загружаются из файла через mmap (только чтение, страницы общие
+для всех процессов с той же сетью) или генерируются Randomize для тестов и бенчмарков.
+Сеть не меняется во время поиска и читается всеми потоками без блокировок.
+*/
+class Network {
+public:
+
+    Network();
+    ~Network();
+    Network(const Network&) = delete;
+    Network& operator=(const Network&) = delete;
+
+    // при ошибке (нет файла, другая версия или размер) сеть не меняется
+    bool Load(const std::string& path);
+    bool Save(const std::string& path) const;
+    // небольшие случайные веса: проверка инкрементального обновления и скорости
+    void Randomize(uint64_t seed);
+
+    void Refresh(Accumulator&, const Logic::PositionFM&) const noexcept;
+    void Update(Accumulator& dst, const Accumulator& src, const Delta&) const noexcept;
+    int Evaluate(const Accumulator&, Logic::Color side) const noexcept;
+
+    // какой набор инструкций выбран при компиляции
+    static const char* Kernel() noexcept;
+
+private:
+
+    void release() noexcept;
+
+private:
+
+    Weights* weights = nullptr;
+    // базовый адрес отображения файла (заголовок + веса), nullptr если веса в куче
+    void* mapped = nullptr;
+    size_t mappedBytes = 0;
+
+};
+
+}
@@ -0,0 +1,113 @@
+#include "pawns.hpp"
+
+namespace Core::Engine
+{
+
+using namespace Logic;
+
+namespace
+{
+
+// бонус проходной пешке по ряду (с точки зрения ее стороны)
+constexpr int PassedMg[8] = {0, 5, 10, 15, 30, 50, 80, 0};
+constexpr int PassedEg[8] = {0, 10, 15, 25, 45, 75, 120, 0};
+
+constexpr int IsolatedMg = -8;
+constexpr int IsolatedEg = -12;
+constexpr int DoubledMg = -8;
+constexpr int DoubledEg = -18;
+
+struct Masks {
+    // поля впереди пешки на своей и соседних вертикалях
+    uint64_t passed[COLOR_COUNT][SQUARE_COUNT];
+    // поля впереди пешки на своей вертикали
+    uint64_t front[COLOR_COUNT][SQUARE_COUNT];
+    // соседние вертикали
+    uint64_t adjacent[8];
+};
+
+const Masks PawnMasks = []()
+{
+    Masks m{};
+
+    auto file = [](int f) {return 0x0101010101010101ULL << f;};
+
+    for(int f = 0; f < 8; ++f)
+        m.adjacent[f] = (f > 0 ? file(f - 1) : 0) | (f < 7 ? file(f + 1) : 0);
+
+    for(int sq = 0; sq < SQUARE_COUNT; ++sq) {
+        const int f = sq % 8;
+        const int r = sq / 8;
+        const uint64_t span = file(f) | m.adjacent[f];
+
+        const uint64_t above = r < 7 ? ~0ULL << (8 * (r + 1)) : 0;
+        const uint64_t below = r > 0 ? ~0ULL >> (8 * (8 - r)) : 0;
+
+        m.front[WHITE][sq] = file(f) & above;
+        m.front[BLACK][sq] = file(f) & below;
+        m.passed[WHITE][sq] = span & above;
+        m.passed[BLACK][sq] = span & below;
+    }
+
+    return m;
+}();
+
+}
+
+const PawnEntry& PawnTable::Probe(const PositionFM& pos) noexcept
+{
+    const uint64_t key = pos.GetPawnHash();
+    PawnEntry& entry = entries[key & (Size - 1)];
+
+    ++probes;
+    if(entry.key == key) {
+        ++hits;
+        return entry;
+    }
+
+    entry.key = key;
+    evaluate(pos, entry);
+    return entry;
+}
+
+void PawnTable::evaluate(const PositionFM& pos, PawnEntry& entry) noexcept
+{
+    int mg[COLOR_COUNT] = {0, 0};
+    int eg[COLOR_COUNT] = {0, 0};
+
+    for(Color us : {Color(WHITE), Color(BLACK)})
+    {
+        const Bitboard ours = pos.GetPieces(us, PAWN);
+        const Bitboard theirs = pos.GetPieces(us.opp(), PAWN);
+
+        entry.passed[us] = Bitboard::Null();
+
+        for(Bitboard pawns = ours; pawns; )
+        {
+            const Square sq = pawns.poplsb();
+            const int relativeRank = us.is(WHITE) ? sq.rank() : 7 - sq.rank();
+
+            if(!(theirs & Bitboard(PawnMasks.passed[us][sq]))) {
+                entry.passed[us] |= sq.bitboard();
+                mg[us] += PassedMg[relativeRank];
+                eg[us] += PassedEg[relativeRank];
+            }
+
+            if(!(ours & Bitboard(PawnMasks.adjacent[sq.file()]))) {
+                mg[us] += IsolatedMg;
+                eg[us] += IsolatedEg;
+            }
+
+            // сдвоенной считается задняя пешка
+            if(ours & Bitboard(PawnMasks.front[us][sq])) {
+                mg[us] += DoubledMg;
+                eg[us] += DoubledEg;
+            }
+        }
+    }
+
+    entry.mg = int16_t(mg[WHITE] - mg[BLACK]);
+    entry.eg = int16_t(eg[WHITE] - eg[BLACK]);
+}
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "logic/bitboard.hpp"
+#include "logic/defs.hpp"
+#include "logic/position.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Core::Engine
+{
+
+// оценка пешечной структуры за белых (белые минус черные) и проходные пешки
+struct PawnEntry {
+    uint64_t key;
+    Logic::Bitboard passed[Logic::COLOR_COUNT];
+    int16_t mg;
+    int16_t eg;
+};
+
+/*
+Кэш пешечной структуры по ключу Position::GetPawnHash.
+Структура меняется только ходами и взятиями пешек, поэтому в поиске
+почти каждая оценка находит готовую запись. Таблица своя у каждого потока,
+запись при коллизии просто перезаписывается.
+*/
+class PawnTable {
+public:
+
+    static constexpr size_t Size = 1 << 13;
+
+    PawnTable() : entries(new PawnEntry[Size]()) {}
+
+    const PawnEntry& Probe(const Logic::PositionFM&) noexcept;
+
+    uint64_t Probes() const noexcept {return probes;}
+    uint64_t Hits() const noexcept {return hits;}
+    void ResetStats() noexcept {probes = hits = 0;}
+
+private:
+
+    static void evaluate(const Logic::PositionFM&, PawnEntry&) noexcept;
+
+private:
+
+    std::unique_ptr<PawnEntry[]> entries;
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+
+};
+
+}
@@ -19,69 +19,209 @@ constexpr int PieceValue[PIECE_COUNT] = {
 
 }
 
+bool IsQuiet(const PositionFM& pos, Move move) 
+{
+    if(pos.GetPiece(move.targ()).isValid())
+        return false;
+
+    switch (move.flag()) 
+    {
+    case DEFAULT_MF:
+    case DOUBLE_MF:
+    case S_CASTLE_MF:
+    case L_CASTLE_MF:
+        return true;
+    default:
+        return false;
+    }
+}
+
 MovePicker::MovePicker(
-    const Logic::MoveList& __moves, 
-    const Logic::PositionFM& __pos, 
-    Logic::Move* __killers, 
-    std::optional<Logic::Move> __ttMove
-) : pos(__pos), killers(__killers)
+    Logic::PositionFM& __pos, 
+    const Logic::Move* __killers, 
+    std::optional<Logic::Move> __ttMove,
+    const History* __history
+) : pos(__pos), stage(Stage::TTMove), inCheck(__pos.IsCheck()), history(__history)
 {
     if(__ttMove)
         ttMove = __ttMove.value();
 
-    cur = end = moves;
-    for(auto move : __moves) {
-        end->setMove(move);
-        end->setScore(computeScore(move));
-        end++;
+    if(__killers) {
+        killers[0] = __killers[0];
+        killers[1] = __killers[1];
     }
 }
 
-std::optional<Move> MovePicker::next() {
-    if(cur == end) return std::nullopt;
+MovePicker::MovePicker(Logic::PositionFM& __pos, bool __quietChecks) 
+    : pos(__pos), stage(Stage::QGenCaptures), inCheck(__pos.IsCheck()), quietChecks(__quietChecks) {}
 
-    auto best = std::max_element(cur, end);
-    std::swap(*cur, *best); 
-    
-    Move move = *cur;
-    cur++;
+std::optional<Move> MovePicker::next() 
+{
+    switch (stage)
+    {
+    case Stage::TTMove:
+        stage = Stage::GenCaptures;
+        if(ttMove && pos.IsLegal(ttMove))
+            return ttMove;
+        [[fallthrough]];
+
+    case Stage::GenCaptures:
+        endCaptures = endQuiets = generate<MoveGenType::Forced>(moves);
+        cur = moves;
+        stage = Stage::GoodCaptures;
+        [[fallthrough]];
+
+    case Stage::GoodCaptures:
+        while(cur != endCaptures) {
+            const ExtMove* best = selectBest(cur++, endCaptures);
+            if(*best == ttMove)
+                continue;
+            // SEE считаем только для хода, который собираемся выдать;
+            // проигрывающие взятия откладываем в начало массива до последней стадии
+            if(!isGoodCapture(*best)) {
+                *endBadCaptures++ = *best;
+                continue;
+            }
+            return *best;
+        }
 
-    return move;
+        // под шахом Forced уже выдал все уходы от шаха
+        if(inCheck) {
+            stage = Stage::BadCaptures;
+            return next();
+        }
+        stage = Stage::Killers;
+        [[fallthrough]];
+
+    case Stage::Killers:
+        while(killerIndex < 2) {
+            const Move killer = killers[killerIndex++];
+            if(!killer || killer == ttMove || (killerIndex == 2 && killer == killers[0]))
+                continue;
+            // killer мог оказаться взятием в этой позиции, тогда он уже был среди взятий
+            if(IsQuiet(pos, killer) && pos.IsLegal(killer))
+                return killer;
+        }
+        stage = Stage::CounterMove;
+        [[fallthrough]];
+
+    case Stage::CounterMove:
+        stage = Stage::GenQuiets;
+        if(history) {
+            const Move counter = history->CounterMove(pos);
+            if(counter && !isSpecial(counter)) {
+                if(IsQuiet(pos, counter) && pos.IsLegal(counter)) {
+                    counterMove = counter;
+                    return counter;
+                }
+            }
+        }
+        [[fallthrough]];
+
+    case Stage::GenQuiets:
+        endQuiets = generate<MoveGenType::Quiet>(endCaptures);
+        cur = endCaptures;
+        stage = Stage::Quiets;
+        [[fallthrough]];
+
+    case Stage::Quiets:
+        while(cur != endQuiets) {
+            const ExtMove* best = selectBest(cur, endQuiets);
+            ++cur;
+            if(!isSpecial(*best))
+                return *best;
+        }
+        stage = Stage::BadCaptures;
+        [[fallthrough]];
+
+    case Stage::BadCaptures:
+        if(badCursor != endBadCaptures)
+            return *badCursor++;
+        stage = Stage::Done;
+        return std::nullopt;
+
+    case Stage::QGenCaptures:
+        endCaptures = endQuiets = generate<MoveGenType::Forced>(moves);
+        cur = moves;
+        stage = Stage::QCaptures;
+        [[fallthrough]];
+
+    case Stage::QCaptures:
+        if(cur != endCaptures)
+            return *selectBest(cur++, endCaptures);
+        // под шахом тихие уходы уже выданы в Forced
+        if(!quietChecks || inCheck) {
+            stage = Stage::Done;
+            return std::nullopt;
+        }
+        stage = Stage::QGenChecks;
+        [[fallthrough]];
+
+    case Stage::QGenChecks:
+        endQuiets = generate<MoveGenType::QuietChecks>(endCaptures);
+        cur = endCaptures;
+        stage = Stage::QChecks;
+        [[fallthrough]];
+
+    case Stage::QChecks:
+        if(cur != endQuiets)
+            return *cur++;
+        stage = Stage::Done;
+        [[fallthrough]];
+
+    case Stage::Done:
+        return std::nullopt;
+    }
+
+    return std::nullopt;
 }
 
-void MovePicker::update(Move bestMovePrevIter) 
+template<MoveGenType MGT>
+ExtMove* MovePicker::generate(ExtMove* out) 
 {
-    std::optional ttMoveOld = ttMove;
-    ttMove = bestMovePrevIter;
-
-    cur = moves;
-    for(ExtMove* it = cur; it != end; ++it) {
-        const Move move = *it;
-        if(ttMoveOld && move == ttMoveOld.value()) {
-            it->setScore(computeScore(move));
-        } else if(move == bestMovePrevIter) {
-            it->setScore(INF);
-        }
+    MoveList list;
+    list.generate<MGT>(pos);
+
+    for(Move move : list) {
+        out->setMove(move);
+        out->setScore(computeScore(move));
+        out++;
     }
+
+    return out;
 }
 
-int MovePicker::computeScore(Move move) const 
+ExtMove* MovePicker::selectBest(ExtMove* begin, ExtMove* end) 
 {
-    if(move == ttMove)
-        return INF;
+    std::swap(*begin, *std::max_element(begin, end));
+    return begin;
+}
 
-    const Logic::Square from = move.from();
-    const Logic::Square targ = move.targ();
+bool MovePicker::isSpecial(Move move) const 
+{
+    return move == ttMove || move == killers[0] || move == killers[1] || move == counterMove;
+}
 
+// взятия - MVV-LVA: сначала самая ценная жертва, при равной - самый дешевый нападающий;
+// тихие ходы - по статистике History
+int MovePicker::computeScore(Move move) const 
+{
     if(std::optional victim = captureTarget(move)) 
-        return 9 * computeCaptureScore(from, *victim);
-
-    if(killers) {
-        if(killers[0] == move || killers[1] == move)
-            return 500;
-    }
+        return 10 * PieceValue[pos.GetPiece(*victim)] - PieceValue[pos.GetPiece(move.from())];
     
-    return 0;
+    return history && IsQuiet(pos, move) ? history->Score(pos, move) : 0;
+}
+
+bool MovePicker::isGoodCapture(Move move) const 
+{
+    std::optional victim = captureTarget(move);
+    return !victim || computeCaptureScore(move.from(), *victim) >= 0;
+}
+
+int MovePicker::See(Move move) const
+{
+    std::optional victim = captureTarget(move);
+    return victim ? computeCaptureScore(move.from(), *victim) : 0;
 }
 
 int MovePicker::computeCaptureScore(Square from, Square targ) const 
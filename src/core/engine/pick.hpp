@@ -6,25 +6,60 @@
 #include "logic/position.hpp"
 #include "logic/square.hpp"
 #include "logic/attack.hpp"
+#include "history.hpp"
+#include <cstdint>
 #include <optional>
 
 namespace Core::Engine 
 {
 
+// ход, который не попадает в Forced: не взятие и не превращение
+bool IsQuiet(const Logic::PositionFM&, Logic::Move);
+
+/*
+Ходы выдаются по стадиям, каждая следующая стадия готовится только
+если предыдущая не дала отсечения:
+ход из TT (проверяется IsLegal без генерации) -> взятия по MVV-LVA с SEE >= 0 -> 
+killer-ходы -> countermove -> тихие ходы по History -> взятия с SEE < 0.
+Для qsearch - только взятия и превращения по MVV-LVA (под шахом - все уходы),
+с quietChecks после них еще тихие шахующие ходы.
+При создании у позиции должны быть актуальные UpdateAttacks.
+*/
 class MovePicker {
 public:
 
     MovePicker(
-        const Logic::MoveList&, 
-        const Logic::PositionFM&, 
-        Logic::Move* killers = nullptr, 
-        std::optional<Logic::Move> ttMove = std::nullopt
+        Logic::PositionFM&, 
+        const Logic::Move* killers, 
+        std::optional<Logic::Move> ttMove = std::nullopt,
+        const History* history = nullptr
     );
+    explicit MovePicker(Logic::PositionFM&, bool quietChecks = false);
     std::optional<Logic::Move> next();
-    void update(Logic::Move bestMovePrevIter);
+    // SEE взятия в единицах PieceValue (для не взятий 0), тем же кодом, что отбирает плохие взятия
+    int See(Logic::Move) const;
 
 private:
 
+    enum class Stage : uint8_t {
+        TTMove, 
+        GenCaptures, GoodCaptures, 
+        Killers, CounterMove,
+        GenQuiets, Quiets, 
+        BadCaptures,
+        QGenCaptures, QCaptures,
+        QGenChecks, QChecks,
+        Done
+    };
+
+private:
+
+    template<Logic::MoveGenType MGT>
+    Logic::ExtMove* generate(Logic::ExtMove* out);
+    Logic::ExtMove* selectBest(Logic::ExtMove* begin, Logic::ExtMove* end);
+    bool isSpecial(Logic::Move) const;
+    bool isGoodCapture(Logic::Move) const;
+
     int computeScore(Logic::Move) const;
     int computeCaptureScore(Logic::Square from, Logic::Square targ) const;
     std::optional<Logic::Square> captureTarget(Logic::Move) const;
@@ -36,12 +71,28 @@ private:
 
 private:
 
-    const Logic::PositionFM& pos;
-    const Logic::Move* killers;
-    Logic::ExtMove moves[Logic::MAX_MOVES_COUNT];
-    Logic::ExtMove* cur;
-    Logic::ExtMove* end;
+    Logic::PositionFM& pos;
+    Stage stage;
+    const bool inCheck;
+    const bool quietChecks = false;
+
     Logic::Move ttMove;
+    Logic::Move killers[2];
+    int killerIndex = 0;
+    const History* history = nullptr;
+    Logic::Move counterMove;
+
+    /*
+    [moves, endCaptures) - взятия, [endCaptures, endQuiets) - тихие ходы.
+    Проигрывающие по SEE взятия переносятся в [moves, endBadCaptures),
+    это место уже пройдено при выборе взятий.
+    */
+    Logic::ExtMove moves[Logic::MAX_MOVES_COUNT];
+    Logic::ExtMove* cur = moves;
+    Logic::ExtMove* endCaptures = moves;
+    Logic::ExtMove* endQuiets = moves;
+    Logic::ExtMove* endBadCaptures = moves;
+    Logic::ExtMove* badCursor = moves;
 
 };
 
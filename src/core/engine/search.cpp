@@ -1,8 +1,7 @@
 #include "search.hpp"
-#include "engine/pick.hpp"
-#include "logic/movelist.hpp"
-#include "logic/position.hpp"
+#include <algorithm>
 #include <cassert>
+#include <iostream>
 
 namespace Core::Engine
 {
@@ -27,9 +26,15 @@ void Search::Launch()
                 cv.wait(lock, [this]() {return stopSearch || allowedToSearch;});
             }
 
-            if(allowedToSearch && iterativeDeepening()) {
+            if(allowedToSearch) {
+                // без ходов в корне результат тоже отдается, с пустым bestMove
+                iterativeDeepening();
+                // сбрасываем флаг до callback-а, чтобы из него можно было сразу вызвать Think
+                {
+                    std::lock_guard lock(mtx);
+                    allowedToSearch = false;
+                }
                 onBestMove(info);
-                allowedToSearch = false;
             }
         }
     });
@@ -39,10 +44,56 @@ void Search::Init(const Options& options)
 {
     stopSearch = false;
     allowedToSearch = false;
-    maxDepth = options.maxDepth;
-    tt.resize(options.ttSizeMB);
+    stackSize = std::clamp(options.stackSize, 16, Logic::MAX_PLY);
+    maxDepth = std::clamp(options.maxDepth, 1, std::min(stackSize - 2, MaxTTDepth));
+    ttFile = options.ttFile;
+
+    if(ttFile.empty() || !tt.load(ttFile, options.ttVerify))
+        tt.resize(options.ttSizeMB);
+
+    Worker::Settings settings;
+    settings.lmr = options.lmr;
+    settings.nullMove = options.nullMove;
+    settings.checkExtensions = options.checkExtensions;
+    settings.qsearchChecks = options.qsearchChecks;
+    settings.pawnStructure = options.pawnStructure;
+    settings.stackSize = stackSize;
+
+    workers.clear();
+
+    network.reset();
+    if(!options.nnueFile.empty()) {
+        network = std::make_unique<NNUE::Network>();
+        if(!network->Load(options.nnueFile)) {
+            std::cerr << "failed to load network from " << options.nnueFile << ", using PeSTO\n";
+            network.reset();
+        }
+    }
+
+    // PeSTO считается быстрее, чем промах по кэшу, кэш окупается только для сети
+    settings.evalCache = options.evalCache && network;
+
+    for(int id = 0; id < std::max(1, options.threads); ++id)
+        workers.push_back(std::make_unique<Worker>(id, settings, tt, network.get(), timer, stopWorkers));
+
     timer.setLimit(options.timeSec);
     onBestMove = std::move(options.onMove);
+    onIteration = std::move(options.onIteration);
+
+    if(onIteration)
+        workers[0]->SetOnIteration([this]() {onIteration(collectInfo(true));});
+}
+
+void Search::SetLimits(std::chrono::milliseconds time, int maxDepth)
+{
+    std::lock_guard lock(mtx);
+
+    if (allowedToSearch) {
+        throw std::runtime_error("Search is already in progress");
+    }
+
+    timer.setLimit(time);
+    this->maxDepth = std::clamp(maxDepth, 1, std::min(stackSize - 2, MaxTTDepth));
 }
 
 void Search::Think() 
@@ -59,221 +110,102 @@ void Search::Think()
         throw std::runtime_error("Search has been stopped");
         }
 
+        // сбрасываем здесь, а не в потоке поиска, чтобы не потерять Halt до его старта
+        stopWorkers = false;
         allowedToSearch = true;
     }
 
     cv.notify_one();
 }
 
+void Search::Halt()
+{
+    std::lock_guard lock(mtx);
+    if(allowedToSearch)
+        stopWorkers = true;
+}
+
 void Search::Stop()
 {
     {
         std::lock_guard lock(mtx);
         stopSearch = true;
         allowedToSearch = false;
+        stopWorkers = true;
     }
     cv.notify_one();
     if(searchThread.joinable())
         searchThread.join();
-}
 
-bool Search::iterativeDeepening()
-{
-    timer.Start();
-
-    info.eval = -Logic::INF - 1;
-    info.time = std::chrono::seconds(0);
-    info.depth = 0;
-    info.nodes = 0;
-    info.tt_cuts = 0;
-    info.bestMove = 0;
-
-    Logic::PositionFM pos(*rootPos);
-    eval.Init(pos);
-
-    Logic::MoveGenerator<Logic::MoveGenType::All> gen(pos);
-    if(gen.moves.empty()) 
-        return false;
-
-    MovePicker picker(gen.moves, pos);
-
-    for(int depth = 1; depth <= maxDepth; ++depth) 
-    {
-        int alpha = -Logic::INF;
-        Logic::Move bestMoveThisIter;
-
-        while(std::optional m = picker.next())
-        {
-            const Logic::Move& move = m.value();
-
-            pos.DoMove(move);
-            eval.Update(move);
-
-            int score = -negamax(pos, depth - 1, -Logic::INF, -alpha);
-
-            pos.UndoMove();
-            eval.Rollback();
-
-            if(timer.TimeUp()) 
-                goto __search_end;
-
-            if(score > alpha) {
-                alpha = score;
-                bestMoveThisIter = move;
-            }
-        }
-
-        info.eval = alpha;
-        info.depth = depth;
-        info.bestMove = bestMoveThisIter;
-
-        picker.update(info.bestMove);
+    if(!ttFile.empty()) {
+        if(!tt.save(ttFile))
+            std::cerr << "failed to save transposition table to " << ttFile << '\n';
+        ttFile.clear();
     }
-
-    __search_end:
-
-    info.time = timer.TimePassed();
-    return true;
 }
 
-int Search::negamax(Logic::PositionFM& pos, int depth, int alpha, int beta)
+void Search::NewGame()
 {
-    if(timer.TimeUp()) 
-        return 0;
-
-    ProbeResult probe = tt.probe(pos.GetHash(), depth, alpha, beta);
+    std::lock_guard lock(mtx);
 
-    if(probe.score) {
-        info.tt_cuts++;
-        return *probe.score;
-    }
-
-
-    if(depth <= 0)
-        return qsearch(pos, alpha, beta);
-
-    info.nodes++;
-
-    Logic::MoveGenerator<Logic::MoveGenType::All> gen(pos);
-    if(gen.moves.empty()) {
-        if(pos.IsCheck()) return -Logic::INF + pos.GetPly();
-        return Logic::DRAW_SCORE;
-    }
-
-    MovePicker picker(gen.moves, pos, killers[pos.GetPly()], probe.move);
-
-
-    const int oldAlpha = alpha;
-    int bestScore = -Logic::INF;
-    Logic::Move bestMove;
-
-
-    while(std::optional m = picker.next())
-    {
-        const Logic::Move& move = m.value();
-
-        pos.DoMove(move);
-        
-        if(pos.IsDraw(rootPos->GetHistory())) {
-            pos.UndoMove();
-            return Logic::DRAW_SCORE;
-        }
-
-        eval.Update(move);
-
-        int score = -negamax(pos, depth - 1, -beta, -alpha);
-
-        pos.UndoMove();
-        eval.Rollback();
-
-        if(timer.TimeUp()) 
-            return 0;
-
-        if(score > bestScore) 
-        {
-            bestScore = score;
-            bestMove = move;
-            if(bestScore > alpha) 
-            {
-                alpha = bestScore;
-                if(alpha >= beta) 
-                {
-                    tt.store(pos.GetHash(), bestScore, move, depth, EntryType::LowerBound);
-
-                    if(
-                        !pos.GetPiece(move.targ()).isValid() && 
-                        move.flag() != Logic::EN_PASSANT_MF
-                    ) {
-                        const int ply = pos.GetPly();
-                        killers[ply][1] = killers[ply][0];
-                        killers[ply][0] = move;
-                    }
-
-                    return bestScore;
-                }
-            }
-        }
+    if (allowedToSearch) {
+        throw std::runtime_error("Search is already in progress");
     }
 
-    if(bestScore <= oldAlpha)
-        tt.store(pos.GetHash(), bestScore, bestMove, depth, EntryType::UpperBound);
-    else
-        tt.store(pos.GetHash(), bestScore, bestMove, depth, EntryType::Exact);
-
-    return bestScore;
+    tt.clear();
+    for(const auto& worker : workers)
+        worker->NewGame();
 }
 
-int Search::qsearch(Logic::PositionFM& pos, int alpha, int beta)
+void Search::iterativeDeepening()
 {
-    if(timer.TimeUp()) 
-        return 0;
-
-    if(pos.IsDraw(rootPos->GetHistory())) 
-        return Logic::DRAW_SCORE;
-
-    info.nodes++;
-
-    int score = eval.Score();
-
-    if(pos.GetPly() == Logic::MAX_HISTORY_SIZE - 1)
-        return score;
-
-    if(score >= beta) 
-        return beta;
-
-    if(score > alpha)
-        alpha = score;
-
-    
-    Logic::MoveGenerator<Logic::MoveGenType::Forced> gen(pos);
-    if(gen.moves.empty()) {
-        if(pos.IsCheck()) return -Logic::INF + pos.GetPly();
-        return score;
-    }
-
-    MovePicker picker(gen.moves, pos);
+    timer.Start();
+    tt.new_search();
 
+    for(const auto& worker : workers)
+        worker->ResetNodes();
 
-    while(std::optional m = picker.next())
-    {
-        const Logic::Move& move = m.value();
+    std::vector<std::thread> helpers;
+    for(size_t i = 1; i < workers.size(); ++i)
+        helpers.emplace_back([this, i]() {workers[i]->Run(*rootPos, maxDepth);});
 
-        pos.DoMove(move);
-        eval.Update(move);
+    workers[0]->Run(*rootPos, maxDepth);
 
-        score = -qsearch(pos, -beta, -alpha);
+    stopWorkers = true;
+    for(std::thread& helper : helpers)
+        helper.join();
 
-        pos.UndoMove();
-        eval.Rollback();
+    info = collectInfo(false);
+}
 
-        if(score > alpha) {
-            alpha = score;
-            if(alpha >= beta)
-                return beta;
-        }
+Search::Info Search::collectInfo(bool running) const
+{
+    const Worker::Result& main = workers[0]->GetResult();
+
+    Info res{};
+    res.eval = main.eval;
+    res.depth = main.depth;
+    res.bestMove = main.bestMove;
+
+    for(const auto& worker : workers) {
+        res.nodes += worker->Nodes();
+        if(running)
+            continue;
+
+        const Worker::Result& result = worker->GetResult();
+        res.tt_cuts += result.tt_cuts;
+        res.cutoffs += result.cutoffs;
+        res.first_move_cutoffs += result.first_move_cutoffs;
+        res.pawn_probes += result.pawn_probes;
+        res.pawn_hits += result.pawn_hits;
+        res.eval_probes += result.eval_probes;
+        res.eval_cache_hits += result.eval_cache_hits;
+        res.eval_tt_hits += result.eval_tt_hits;
     }
+    res.hashfull = tt.hashfull();
+    res.time = timer.TimePassed();
 
-    return alpha;
+    return res;
 }
 
 
@@ -1,17 +1,21 @@
 #pragma once 
 
-#include "eval.hpp"
 #include "tt.hpp"
 #include "timer.hpp"
+#include "worker.hpp"
 #include "logic/move.hpp"
 #include "logic/position.hpp"
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <memory>
+#include <string>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <vector>
 
 namespace Core::Engine
 {
@@ -19,7 +23,12 @@ namespace Core::Engine
 /* 
 В Launch запускается поток, который ждет сигнала на старт поиска.
 В Think посылается сигнал на старт поиска.
-Когда поиск закончен, вызывается callback onBestMove.
+Поток поиска является главным Worker-ом: на время поиска он запускает
+threads - 1 вспомогательных Worker-ов (Lazy SMP), которые делят с ним
+таблицу транспозиций, и останавливает их, когда сам заканчивает.
+Когда поиск закончен, вызывается callback onBestMove
+(в позиции без ходов - с пустым bestMove и оценкой мата или ничьей),
+после каждой итерации главного потока - onIteration (если задан).
 */
 class Search {
 public:
@@ -27,7 +36,16 @@ public:
     struct Info {
         long long nodes;
         long long tt_cuts;
-        std::chrono::seconds time;
+        long long cutoffs;
+        long long first_move_cutoffs;
+        long long pawn_probes;
+        long long pawn_hits;
+        // запросы статической оценки, попадания в EvalCache и оценки из записей TT
+        long long eval_probes;
+        long long eval_cache_hits;
+        long long eval_tt_hits;
+        int hashfull;
+        std::chrono::milliseconds time;
         int depth;
         int eval;
         Logic::Move bestMove;
@@ -35,8 +53,34 @@ public:
     struct Options {
         uint64_t timeSec;
         uint64_t ttSizeMB;
+        // ограничивается stackSize - 2 (корень на ply 1, листья - на ply 1 + maxDepth)
+        // и MaxTTDepth (глубина в записи таблицы транспозиций)
         int maxDepth;
+        int threads = 1;
+        // стек поиска каждого потока в ply, от 16 до Logic::MAX_PLY;
+        // все, что дальше maxDepth, достается продолжениям qsearch
+        int stackSize = Logic::DEFAULT_STACK_SIZE;
+        // сокращения перебора, выключаются для A/B сравнения
+        bool lmr = true;
+        bool nullMove = true;
+        // продление шахов и тихие шахи в qsearch
+        bool checkExtensions = true;
+        bool qsearchChecks = true;
+        // пешечная структура в оценке PeSTO
+        bool pawnStructure = true;
+        // кэш статической оценки по ключу позиции (только при оценке NNUE)
+        bool evalCache = true;
+        // если задан, таблица транспозиций загружается из файла в Init 
+        // и сохраняется в него в Stop
+        std::string ttFile;
+        // проверять контрольную сумму всего файла таблицы при загрузке
+        bool ttVerify = false;
+        // если задан и загружается, оценка идет нейросетью вместо PeSTO
+        std::string nnueFile;
         mutable std::function<void(Info)> onMove;
+        // промежуточный результат, вызывается из потока поиска;
+        // во время поиска заполнены только nodes, hashfull, time, depth, eval и bestMove
+        mutable std::function<void(Info)> onIteration;
     };
 
 public:
@@ -47,28 +91,40 @@ public:
     void Init(const Options&);
     void Launch();
     void Think();
+    // прерывает текущий поиск, результат как обычно приходит в onMove
+    void Halt();
     void Stop();
+    // очищает таблицу транспозиций перед новой партией
+    void NewGame();
 
     void SetPosition(const Logic::PositionDM& pos) noexcept {
         this->rootPos = &pos;
     }
 
+    // лимиты следующих поисков вместо заданных в Init, между поисками
+    void SetLimits(std::chrono::milliseconds time, int maxDepth);
+    // меняет лимит идущего поиска, время считается от его начала (UCI ponderhit)
+    void SetTimeLimit(std::chrono::milliseconds time) noexcept {timer.setLimit(time);}
+
 private:
 
-    bool iterativeDeepening();
-    int negamax(Logic::PositionFM&, int depth, int alpha, int beta);
-    int qsearch(Logic::PositionFM&, int alpha, int beta);
+    void iterativeDeepening();
+    // во время поиска у вспомогательных потоков безопасно читается только число узлов
+    Info collectInfo(bool running) const;
 
 private:
     
     Info info;
     Timer timer;
     Transposition tt;
-    Evaluation eval;
-    Logic::Move killers[Logic::MAX_HISTORY_SIZE][2];
+    std::unique_ptr<NNUE::Network> network;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> stopWorkers;
 
     const Logic::PositionDM* rootPos;
     int maxDepth;
+    int stackSize;
+    std::string ttFile;
 
     std::thread searchThread;
     std::mutex mtx;
@@ -78,6 +134,7 @@ private:
     bool allowedToSearch;
 
     std::function<void(Info)> onBestMove;
+    std::function<void(Info)> onIteration;
 };
 
-}
\ No newline at end of file
+}
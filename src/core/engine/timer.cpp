@@ -8,7 +8,7 @@ namespace Core::Engine
 
 bool Timer::TimeUp() const noexcept 
 {
-    return now() - start_time >= limit;
+    return now() - start_time >= limit.load(std::memory_order_relaxed);
 }
 
 uint64_t Timer::now() const noexcept {
@@ -17,10 +17,8 @@ uint64_t Timer::now() const noexcept {
     ).count();
 }
 
-std::chrono::seconds Timer::TimePassed() const noexcept {
-    using namespace std::chrono;
-    auto ms = static_cast<milliseconds>(now() - start_time);
-    return duration_cast<seconds>(ms);
+std::chrono::milliseconds Timer::TimePassed() const noexcept {
+    return std::chrono::milliseconds(now() - start_time);
 }
 
 
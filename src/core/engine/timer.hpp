@@ -1,19 +1,25 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 
 namespace Core::Engine
 {
 
+/*
+Лимит отсчитывается от Start в миллисекундах.
+Его можно менять во время поиска (UCI ponderhit), потоки поиска видят новое значение сразу.
+*/
 class Timer 
 {
 public:
 
-    void setLimit(uint64_t l) noexcept {limit = l * 1000;}
+    void setLimit(uint64_t sec) noexcept {limit = sec * 1000;}
+    void setLimit(std::chrono::milliseconds ms) noexcept {limit = ms.count();}
     bool TimeUp() const noexcept;
     void Start() noexcept {start_time = now();}
-    std::chrono::seconds TimePassed() const noexcept;
+    std::chrono::milliseconds TimePassed() const noexcept;
 
 private:
 
@@ -22,8 +28,8 @@ private:
 private:
 
     uint64_t start_time;
-    uint64_t limit;
+    std::atomic<uint64_t> limit;
 
 };
 
-}
\ No newline at end of file
+}
@@ -1,102 +1,471 @@
 #include "tt.hpp"
 #include "logic/move.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <new>
 #include <optional>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#elif defined(_WIN32)
+    #include <malloc.h>
+#endif
 
 namespace Core::Engine
 {
 
-struct TTEntry 
+namespace 
+{
+
+/*
+Упакованное содержимое записи (64 бита):
+[0, 16) - ход, [16, 32) - оценка, [32, 40) - глубина, [40, 42) - тип,
+[42, 48) - поколение (номер поиска, в котором запись сохранена),
+[48, 64) - статическая оценка позиции (NoEval, если не считалась)
+*/
+constexpr uint8_t GenerationMask = 63;
+
+struct EntryData
 {
-    uint16_t key;
     int16_t score;
     uint16_t move;
     uint8_t depth;
     EntryType flag;
+    uint8_t generation;
+    int16_t eval;
+
+    static EntryData Unpack(uint64_t data) noexcept {
+        return {
+            int16_t(uint16_t(data >> 16)),
+            uint16_t(data),
+            uint8_t(data >> 32),
+            EntryType((data >> 40) & 3),
+            uint8_t((data >> 42) & GenerationMask),
+            int16_t(uint16_t(data >> 48))
+        };
+    }
+
+    uint64_t pack() const noexcept {
+        return 
+            uint64_t(move) | 
+            uint64_t(uint16_t(score)) << 16 | 
+            uint64_t(depth) << 32 | 
+            uint64_t(flag) << 40 |
+            uint64_t(generation & GenerationMask) << 42 |
+            uint64_t(uint16_t(eval)) << 48;
+    }
+
+    // сколько поисков назад сохранена запись
+    int age(uint8_t current) const noexcept {
+        return (current - generation) & GenerationMask;
+    }
+
+    // чем меньше, тем охотнее запись вытесняется: 
+    // один пройденный поиск стоит 8 полуходов глубины
+    int worth(uint8_t current) const noexcept {
+        return depth - 8 * age(current);
+    }
 };
 
-constexpr int ClusterSize = 3;
+}
 
-struct Cluster {
+/*
+Запись без блокировок: ключ хранится как key ^ data.
+Если другой поток успел перезаписать одно из слов между двумя чтениями,
+проверка ключа не пройдет и запись будет считаться промахом.
+*/
+struct TTEntry 
+{
+    std::atomic<uint64_t> key;
+    std::atomic<uint64_t> data;
+
+    bool load(uint64_t k, EntryData& out) const noexcept {
+        const uint64_t d = data.load(std::memory_order_relaxed);
+        if((key.load(std::memory_order_relaxed) ^ d) != k)
+            return false;
+        out = EntryData::Unpack(d);
+        return true;
+    }
+
+    void save(uint64_t k, const EntryData& in) noexcept {
+        const uint64_t d = in.pack();
+        key.store(k ^ d, std::memory_order_relaxed);
+        data.store(d, std::memory_order_relaxed);
+    }
+};
+
+constexpr int ClusterSize = 4;
+constexpr size_t CacheLineSize = 64;
+
+// кластер занимает ровно одну кэш-линию и с нее начинается
+struct alignas(CacheLineSize) Cluster {
     TTEntry entry[ClusterSize];
 };
 
-Transposition::~Transposition() {clear();}
+static_assert(sizeof(Cluster) == CacheLineSize);
+
+namespace 
+{
+
+#ifdef __linux__
+constexpr size_t TableAlignment = 2 * 1024 * 1024; // размер huge page
+#else
+constexpr size_t TableAlignment = CacheLineSize;
+#endif
+
+// меньше этого размера очистка в несколько потоков не окупается
+constexpr size_t ParallelClearBytes = 64 * 1024 * 1024;
+
+/*
+Сначала пробуем явные huge pages (MAP_HUGETLB, нужны зарезервированные
+страницы в vm.nr_hugepages), при неудаче - выровненная память с
+madvise(MADV_HUGEPAGE), чтобы ее подхватили transparent huge pages.
+TableMemory::Anonymous означает, что память получена через mmap и уже обнулена.
+*/
+void* AllocTable(size_t bytes, TableMemory& memory)
+{
+    memory = TableMemory::Heap;
+
+#ifdef __linux__
+    void* huge = mmap(
+        nullptr, bytes, 
+        PROT_READ | PROT_WRITE, 
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, 
+        -1, 0
+    );
+    if(huge != MAP_FAILED) {
+        memory = TableMemory::Anonymous;
+        return huge;
+    }
+#endif
+
+#ifdef _WIN32
+    void* mem = _aligned_malloc(bytes, TableAlignment);
+#else
+    void* mem = std::aligned_alloc(TableAlignment, bytes);
+#endif
+
+#ifdef __linux__
+    if(mem)
+        madvise(mem, bytes, MADV_HUGEPAGE);
+#endif
+
+    return mem;
+}
+
+void FreeTable(void* mem, size_t bytes, TableMemory memory)
+{
+#ifdef __linux__
+    if(memory != TableMemory::Heap) {
+        munmap(mem, bytes);
+        return;
+    }
+#endif
+
+#ifdef _WIN32
+    _aligned_free(mem);
+#else
+    std::free(mem);
+#endif
+}
+
+/*
+Формат файла таблицы: заголовок на FileHeaderBytes байт, за ним кластеры как есть.
+Таблица начинается с границы страницы, поэтому файл можно отобразить
+в память и использовать без копирования и разбора.
+FileVersion нужно увеличивать при любом изменении упаковки EntryData.
+*/
+constexpr char FileMagic[8] = {'A', '1', '0', '1', 'T', 'T', '\0', '\0'};
+constexpr uint32_t FileVersion = 2;
+constexpr size_t FileHeaderBytes = 4096;
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t clusterBytes;
+    uint64_t clusters;
+    uint64_t checksum;
+    uint8_t generation;
+
+    bool valid(size_t payload) const noexcept {
+        return 
+            std::memcmp(magic, FileMagic, sizeof(magic)) == 0 &&
+            version == FileVersion &&
+            clusterBytes == sizeof(Cluster) &&
+            clusters != 0 &&
+            clusters * sizeof(Cluster) == payload;
+    }
+};
+
+static_assert(sizeof(FileHeader) <= FileHeaderBytes);
+
+// FNV-подобное перемешивание в четыре независимые цепочки, 
+// чтобы умножения не ждали друг друга
+uint64_t Checksum(const Cluster* table, size_t size) noexcept
+{
+    constexpr uint64_t Prime = 0x100000001b3ULL;
+    uint64_t lane[4] = {
+        0xcbf29ce484222325ULL, 0x84222325cbf29ce4ULL,
+        0x9ce484222325cbf2ULL, 0x2325cbf29ce48422ULL
+    };
+
+    for(size_t i = 0; i < size; ++i) {
+        const TTEntry* entry = table[i].entry;
+        for(int j = 0; j < ClusterSize; j += 2) {
+            lane[0] = (lane[0] ^ entry[j].key.load(std::memory_order_relaxed)) * Prime;
+            lane[1] = (lane[1] ^ entry[j].data.load(std::memory_order_relaxed)) * Prime;
+            lane[2] = (lane[2] ^ entry[j + 1].key.load(std::memory_order_relaxed)) * Prime;
+            lane[3] = (lane[3] ^ entry[j + 1].data.load(std::memory_order_relaxed)) * Prime;
+        }
+    }
+
+    return lane[0] ^ (lane[1] << 16 | lane[1] >> 48) 
+        ^ (lane[2] << 32 | lane[2] >> 32) ^ (lane[3] << 48 | lane[3] >> 16);
+}
+
+}
+
+Transposition::~Transposition() {release();}
 
 void Transposition::resize(size_t mb) 
 {
-    clear();
+    release();
+
+    size = mb * 1024 * 1024 / sizeof(Cluster);
+    allocated = (size * sizeof(Cluster) + TableAlignment - 1) / TableAlignment * TableAlignment;
+
+    table = static_cast<Cluster*>(AllocTable(allocated, memory));
+    if(!table) {
+        size = allocated = 0;
+        throw std::bad_alloc();
+    }
+
+    if(memory == TableMemory::Heap)
+        clear();
+}
+
+bool Transposition::save(const std::string& path) const
+{
+    if(!table)
+        return false;
+
+    FileHeader header{};
+    std::memcpy(header.magic, FileMagic, sizeof(FileMagic));
+    header.version = FileVersion;
+    header.clusterBytes = sizeof(Cluster);
+    header.clusters = size;
+    header.checksum = Checksum(table, size);
+    header.generation = generation;
+
+    char page[FileHeaderBytes] = {};
+    std::memcpy(page, &header, sizeof(header));
+
+    // пишем во временный файл и переименовываем, 
+    // чтобы прерванная запись не испортила прошлое сохранение
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(page, FileHeaderBytes);
+        out.write(reinterpret_cast<const char*>(table), size * sizeof(Cluster));
+        if(!out) {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    return !ec;
+}
+
+bool Transposition::load(const std::string& path, bool verify)
+{
+#ifdef __linux__
+    const int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || size_t(st.st_size) <= FileHeaderBytes) {
+        close(fd);
+        return false;
+    }
+
+    const size_t bytes = st.st_size;
+
+    // MAP_PRIVATE: страницы подгружаются из page cache по мере обращения, 
+    // а записи поиска остаются в памяти процесса и не уходят в файл
+    void* mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mem == MAP_FAILED)
+        return false;
+
+    const FileHeader* header = static_cast<const FileHeader*>(mem);
+    const Cluster* clusters = reinterpret_cast<const Cluster*>(static_cast<char*>(mem) + FileHeaderBytes);
+
+    // без verify страницы таблицы не трогаются до первых probe/store
+    if(
+        !header->valid(bytes - FileHeaderBytes) || 
+        (verify && Checksum(clusters, header->clusters) != header->checksum)
+    ) {
+        munmap(mem, bytes);
+        return false;
+    }
+
+    release();
+
+    table = const_cast<Cluster*>(clusters);
+    size = header->clusters;
+    allocated = bytes;
+    memory = TableMemory::File;
+    generation = header->generation & GenerationMask;
+
+    return true;
+#else
+    std::ifstream in(path, std::ios::binary);
+    if(!in)
+        return false;
+
+    char page[FileHeaderBytes];
+    FileHeader header;
+    if(!in.read(page, FileHeaderBytes))
+        return false;
+    std::memcpy(&header, page, sizeof(header));
+
+    in.seekg(0, std::ios::end);
+    const size_t bytes = size_t(in.tellg());
+    if(bytes <= FileHeaderBytes || !header.valid(bytes - FileHeaderBytes))
+        return false;
+    in.seekg(FileHeaderBytes);
+
+    TableMemory kind;
+    const size_t length = (header.clusters * sizeof(Cluster) + TableAlignment - 1) / TableAlignment * TableAlignment;
+    Cluster* mem = static_cast<Cluster*>(AllocTable(length, kind));
+    if(!mem)
+        return false;
+
+    if(
+        !in.read(reinterpret_cast<char*>(mem), header.clusters * sizeof(Cluster)) ||
+        (verify && Checksum(mem, header.clusters) != header.checksum)
+    ) {
+        FreeTable(mem, length, kind);
+        return false;
+    }
+
+    release();
+
+    table = mem;
+    size = header.clusters;
+    allocated = length;
+    memory = kind;
+    generation = header.generation & GenerationMask;
+
+    return true;
+#endif
+}
+
+void Transposition::clear()
+{
+    const size_t bytes = size * sizeof(Cluster);
+    const size_t threads = bytes < ParallelClearBytes 
+        ? 1 
+        : std::max(1u, std::thread::hardware_concurrency());
 
-    constexpr size_t bytes = sizeof(Cluster);
-    size = mb * 1024 * 1024 / bytes;
-    table = new Cluster[size];
+    if(threads == 1) {
+        std::memset(static_cast<void*>(table), 0, bytes);
+        return;
+    }
+
+    const size_t chunk = (size + threads - 1) / threads;
+    std::vector<std::thread> workers;
+
+    for(size_t i = 0; i < threads; ++i) 
+    {
+        const size_t begin = std::min(size, i * chunk);
+        const size_t end = std::min(size, begin + chunk);
 
-    for (size_t i = 0; i < size; ++i)
-        std::memset(&table[i], 0, bytes);
+        workers.emplace_back([this, begin, end]() {
+            std::memset(static_cast<void*>(table + begin), 0, (end - begin) * sizeof(Cluster));
+        });
+    }
+
+    for(std::thread& worker : workers)
+        worker.join();
 }
 
 void Transposition::store(
-    uint64_t key, int16_t score, Logic::Move move, uint8_t depth, EntryType flag
+    uint64_t key, int16_t score, Logic::Move move, uint8_t depth, EntryType flag, int16_t eval
 ) {
     TTEntry* entry = first_entry(key);
-    const uint16_t key16 = uint16_t(key);
+    EntryData data{score, move, depth, flag, generation, eval};
 
+    EntryData old[ClusterSize];
     for (int i = 0; i < ClusterSize; ++i) {
-        if(entry[i].key == key16) {
-            if(flag == EntryType::Exact || depth >= entry[i].depth) 
-            {
-                entry[i].depth = depth;
-                entry[i].score = score;
-                entry[i].flag = flag;
-                entry[i].move = move;
+        if(entry[i].load(key, old[i])) {
+            if(flag == EntryType::Exact || depth >= old[i].depth || old[i].age(generation)) {
+                // статическая оценка от позиции не зависит, старую не теряем
+                if(data.eval == NoEval)
+                    data.eval = old[i].eval;
+                entry[i].save(key, data);
             }
             return;
         }
+        old[i] = EntryData::Unpack(entry[i].data.load(std::memory_order_relaxed));
     }
 
-    TTEntry* replace = entry;
+    int replace = 0;
     for (int i = 1; i < ClusterSize; ++i) 
-        if(entry[i].depth < replace->depth) 
-            replace = &entry[i];
+        if(old[i].worth(generation) < old[replace].worth(generation)) 
+            replace = i;
 
-    replace->key = key16;
-    replace->depth = depth;
-    replace->score = score;
-    replace->flag = flag;
-    replace->move = move;
+    entry[replace].save(key, data);
 }
 
 ProbeResult Transposition::probe(uint64_t key, uint8_t depth, int alpha, int beta) const 
 {
     TTEntry* entry = first_entry(key);
-    const uint16_t key16 = uint16_t(key);
 
     for(int i = 0; i < ClusterSize; ++i)
     {
-        if(entry[i].key == key16)
+        EntryData e;
+        if(entry[i].load(key, e))
         {
             ProbeResult res;
 
-            if(entry[i].depth >= depth)
+            if(e.depth >= depth)
             {
-                switch (entry[i].flag) 
+                switch (e.flag) 
                 {
                 case EntryType::Exact:
-                    res.score = entry[i].score;
+                    res.score = e.score;
                     break;
                 case EntryType::LowerBound:
-                    if(entry[i].score >= beta)
-                        res.score = entry[i].score;
+                    if(e.score >= beta)
+                        res.score = e.score;
                     break;
                 case EntryType::UpperBound:
-                    if(entry[i].score <= alpha)
-                        res.score = entry[i].score;
+                    if(e.score <= alpha)
+                        res.score = e.score;
                     break;
                 }
             }
 
-            res.move = entry[i].move;
+            res.move = e.move;
+            if(e.eval != NoEval)
+                res.eval = e.eval;
 
             return res;
         }
@@ -106,13 +475,47 @@ ProbeResult Transposition::probe(uint64_t key, uint8_t depth, int alpha, int bet
 }
 
 
-void Transposition::clear() 
+void Transposition::new_search() noexcept
 {
-    if(table) {
-        delete[] table;
+    generation = (generation + 1) & GenerationMask;
+}
+
+int Transposition::hashfull() const noexcept
+{
+    constexpr size_t Sample = 1000;
+    const size_t clusters = std::min<size_t>(Sample, size);
+    if(!clusters)
+        return 0;
+
+    size_t used = 0;
+    for(size_t i = 0; i < clusters; ++i) {
+        for(const TTEntry& entry : table[i].entry) {
+            const uint64_t data = entry.data.load(std::memory_order_relaxed);
+            used += data && EntryData::Unpack(data).generation == generation;
+        }
+    }
+
+    return used * 1000 / (clusters * ClusterSize);
+}
+
+void Transposition::release() 
+{
+    if(memory == TableMemory::File) {
+        // отображение файла начинается с заголовка, а не с таблицы
+        FreeTable(reinterpret_cast<char*>(table) - FileHeaderBytes, allocated, memory);
+    }
+    else if(table) {
+        FreeTable(table, allocated, memory);
     }
     table = nullptr;
     size = 0;
+    allocated = 0;
+    memory = TableMemory::Heap;
+}
+
+void Transposition::prefetch(uint64_t key) const noexcept
+{
+    __builtin_prefetch(first_entry(key));
 }
 
 TTEntry* Transposition::first_entry(uint64_t key) const
@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <optional>
+#include <string>
 
 namespace Core::Engine
 {
@@ -17,28 +18,60 @@ enum class EntryType : uint8_t {
 struct TTEntry;
 struct Cluster;
 
+// откуда взята память под таблицу
+enum class TableMemory : uint8_t {
+    Heap,       // aligned_alloc
+    Anonymous,  // mmap с huge pages
+    File        // отображенный файл сохраненной таблицы
+};
+
+// статическая оценка в записи отсутствует
+constexpr int16_t NoEval = INT16_MIN;
+// глубина в записи хранится в uint8_t, глубже итерации не идут
+constexpr int MaxTTDepth = UINT8_MAX;
+
 struct ProbeResult {
     std::optional<int16_t> score;
     std::optional<Logic::Move> move;
+    // статическая оценка позиции, если ее сохранили (не зависит от глубины записи)
+    std::optional<int16_t> eval;
 };
 
+// store/probe не блокируют и безопасны при одновременном доступе из нескольких потоков
 class Transposition {
 public:
 
     ~Transposition();
     void resize(size_t);
-    void store(uint64_t key, int16_t score, Logic::Move move, uint8_t depth, EntryType flag);
+    // сохранение таблицы в файл и загрузка обратно; при загрузке проверяются заголовок, 
+    // версия и размер, а контрольная сумма - только с verify (она читает весь файл сразу);
+    // размер берется из файла, при ошибке таблица не меняется
+    bool save(const std::string& path) const;
+    bool load(const std::string& path, bool verify = false);
+    // обнуляет таблицу без перевыделения (новая партия)
+    void clear();
+    void store(uint64_t key, int16_t score, Logic::Move move, uint8_t depth, EntryType flag, int16_t eval = NoEval);
     ProbeResult probe(uint64_t key, uint8_t depth, int alpha, int beta) const;
+    // загружает кластер в кэш заранее, пока идет работа до probe
+    void prefetch(uint64_t key) const noexcept;
+
+    // начинает новое поколение: записи прошлых поисков вытесняются охотнее
+    void new_search() noexcept;
+    // заполненность текущим поколением в промилле (по первым 1000 кластерам)
+    int hashfull() const noexcept;
 
 private:
 
-    void clear();
+    void release();
     TTEntry* first_entry(uint64_t key) const;
 
 private:
 
     Cluster* table = nullptr;
     uint64_t size = 0;
+    size_t allocated = 0;
+    TableMemory memory = TableMemory::Heap;
+    uint8_t generation = 0;
 
 };
 
@@ -0,0 +1,460 @@
+#include "worker.hpp"
+#include "engine/pick.hpp"
+#include "logic/movelist.hpp"
+#include "logic/position.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+
+namespace Core::Engine
+{
+
+namespace 
+{
+
+// окно аспирации вокруг оценки прошлой итерации и глубина, с которой оно включается
+constexpr int AspirationDelta = 25;
+constexpr int AspirationDepth = 4;
+
+constexpr bool IsMate(int score) {
+    return std::abs(score) >= Logic::INF - Logic::MAX_PLY;
+}
+
+// null move: минимальная глубина, с которой он пробуется, и с которой результат перепроверяется
+constexpr int NullMinDepth = 3;
+constexpr int NullVerifyDepth = 8;
+
+// LMR: с какой глубины и с какого по счету хода (в порядке MovePicker) сокращаем
+constexpr int LmrMinDepth = 3;
+constexpr int LmrMinMoves = 3;
+
+// Reductions[depth][moveCount] ~ ln(depth) * ln(moveCount) / 2.25, глубины больше таблицы берут последнюю строку;
+// moveCount считается с 1 и доходит до MAX_MOVES_COUNT включительно
+constexpr int ReductionDepths = 64;
+const auto Reductions = []() 
+{
+    std::array<std::array<int, Logic::MAX_MOVES_COUNT + 1>, ReductionDepths> table{};
+    for(int depth = 1; depth < ReductionDepths; ++depth)
+        for(int count = 1; count <= Logic::MAX_MOVES_COUNT; ++count)
+            table[depth][count] = int(0.5 + std::log(depth) * std::log(count) / 2.25);
+    return table;
+}();
+
+// без фигур у стороны на ходу пропуск хода слишком часто ошибается из-за цугцванга
+bool HasNonPawnMaterial(const Logic::PositionFM& pos) 
+{
+    return pos.GetPieces(pos.GetSide(), Logic::KNIGHT, Logic::BISHOP, Logic::ROOK, Logic::QUEEN);
+}
+
+}
+
+bool Worker::Run(const Logic::PositionDM& rootPos, int maxDepth)
+{
+    this->rootPos = &rootPos;
+
+    result.eval = -Logic::INF - 1;
+    result.depth = 0;
+    result.nodes = 0;
+    result.tt_cuts = 0;
+    result.cutoffs = 0;
+    result.first_move_cutoffs = 0;
+    result.pawn_probes = 0;
+    result.pawn_hits = 0;
+    result.eval_probes = 0;
+    result.eval_cache_hits = 0;
+    result.eval_tt_hits = 0;
+    result.bestMove = 0;
+
+    pos.SetPosition(rootPos);
+    rootPly = pos.GetPly();
+    eval.Init(pos);
+    eval.ResetStats();
+    history.Age();
+
+    Logic::MoveGenerator<Logic::MoveGenType::All> gen(pos);
+    if(gen.moves.empty()) {
+        result.eval = pos.IsCheck() ? -Logic::INF : Logic::DRAW_SCORE;
+        collectStats();
+        return false;
+    }
+
+    // вспомогательные потоки с нечетным id начинают с глубины 2,
+    // чтобы потоки не шли по итерациям синхронно
+    for(int depth = 1 + id % 2; depth <= maxDepth; ++depth)
+    {
+        rootDepth = depth;
+        int delta = AspirationDelta;
+        int alpha = -Logic::INF;
+        int beta = Logic::INF;
+
+        if(depth >= AspirationDepth && !IsMate(result.eval)) {
+            alpha = std::max(result.eval - delta, -Logic::INF);
+            beta = std::min(result.eval + delta, int(Logic::INF));
+        }
+
+        Logic::Move bestMoveThisIter = result.bestMove;
+        int score;
+
+        // при выходе за окно ищем заново с расширенным окном
+        while(true)
+        {
+            score = searchRoot(pos, depth, alpha, beta, bestMoveThisIter);
+
+            if(stopped()) {
+                collectStats();
+                return true;
+            }
+
+            if(score <= alpha) {
+                beta = (alpha + beta) / 2;
+                alpha = std::max(score - delta, -Logic::INF);
+            } else if(score >= beta) {
+                beta = std::min(score + delta, int(Logic::INF));
+            } else {
+                break;
+            }
+
+            delta *= 2;
+        }
+
+        result.eval = score;
+        result.depth = depth;
+        result.bestMove = bestMoveThisIter;
+        publishedNodes.store(result.nodes, std::memory_order_relaxed);
+
+        if(onIteration)
+            onIteration();
+    }
+
+    collectStats();
+    return true;
+}
+
+void Worker::collectStats() noexcept
+{
+    publishedNodes.store(result.nodes, std::memory_order_relaxed);
+    result.pawn_probes = eval.GetPawnTable().Probes();
+    result.pawn_hits = eval.GetPawnTable().Hits();
+}
+
+int Worker::staticEval(const Logic::PositionFM& pos, std::optional<int16_t> ttEval)
+{
+    result.eval_probes++;
+
+    if(!settings.evalCache)
+        return eval.Score();
+
+    if(ttEval) {
+        result.eval_tt_hits++;
+        return *ttEval;
+    }
+
+    if(std::optional cached = evalCache.Probe(pos.GetHash())) {
+        result.eval_cache_hits++;
+        return *cached;
+    }
+
+    const int score = eval.Score();
+    evalCache.Store(pos.GetHash(), score);
+    return score;
+}
+
+void Worker::NewGame() noexcept
+{
+    history.Clear();
+    for(int ply = 0; ply < settings.stackSize; ++ply)
+        stack[ply].killers[0] = stack[ply].killers[1] = Logic::Move{};
+}
+
+int Worker::searchRoot(Logic::PositionFM& pos, int depth, int alpha, int beta, Logic::Move& bestMove) 
+{
+    int bestScore = -Logic::INF;
+    bool first = true;
+
+    // лучший ход прошлой итерации (или прошлого окна) идет первым
+    pos.UpdateAttacks();
+    MovePicker picker(pos, nullptr, bestMove);
+
+    while(std::optional m = picker.next())
+    {
+        const Logic::Move& move = m.value();
+
+        pos.DoMove(move);
+        tt.prefetch(pos.GetHash());
+
+        int score;
+        if(pos.IsDraw(rootPos->GetHistory())) {
+            score = Logic::DRAW_SCORE;
+            pos.UndoMove();
+        } else {
+            eval.Update(move);
+
+            if(first) {
+                score = -negamax(pos, depth - 1, -beta, -alpha);
+            } else {
+                // PVS: остальные ходы проверяем нулевым окном, 
+                // полное окно - только если ход оказался лучше
+                score = -negamax(pos, depth - 1, -alpha - 1, -alpha);
+                if(score > alpha && score < beta)
+                    score = -negamax(pos, depth - 1, -beta, -alpha);
+            }
+
+            pos.UndoMove();
+            eval.Rollback();
+        }
+
+        if(stopped())
+            return bestScore;
+
+        first = false;
+
+        if(score > bestScore) {
+            bestScore = score;
+            if(score > alpha) {
+                alpha = score;
+                bestMove = move;
+                if(alpha >= beta)
+                    break;
+            }
+        }
+    }
+
+    return bestScore;
+}
+
+int Worker::negamax(Logic::PositionFM& pos, int depth, int alpha, int beta, bool nullAllowed)
+{
+    if(stopped())
+        return 0;
+
+    // мат не может быть ближе, чем здесь или на следующем ply: окно за этими границами не нужно
+    alpha = std::max(alpha, -Logic::INF + pos.GetPly());
+    beta = std::min(beta, Logic::INF - pos.GetPly() - 1);
+    if(alpha >= beta)
+        return alpha;
+
+    ProbeResult probe = tt.probe(pos.GetHash(), depth, alpha, beta);
+
+    if(probe.score) {
+        result.tt_cuts++;
+        return *probe.score;
+    }
+
+
+    if(depth <= 0 || stackFull(pos))
+        return qsearch(pos, alpha, beta, settings.qsearchChecks);
+
+    countNode();
+
+    pos.UpdateAttacks();
+
+    const bool pvNode = beta - alpha > 1;
+    const bool inCheck = pos.IsCheck();
+
+    // статическая оценка считается только если понадобилась, и сохраняется в TT вместе с узлом
+    int16_t nodeEval = NoEval;
+    auto getStaticEval = [&]() {
+        if(nodeEval == NoEval)
+            nodeEval = int16_t(staticEval(pos, probe.eval));
+        return nodeEval;
+    };
+
+    /*
+    Null move: отдаем ход сопернику и ищем на уменьшенную глубину.
+    Если даже так счет >= beta, узел отсекается. На большой глубине 
+    отсечение подтверждается обычным поиском без null move (verified null move).
+    */
+    if(
+        settings.nullMove && nullAllowed && !pvNode && !inCheck &&
+        depth >= NullMinDepth && 
+        HasNonPawnMaterial(pos) &&
+        getStaticEval() >= beta
+    ) {
+        const int R = 3 + depth / 6;
+
+        pos.DoNullMove();
+        int score = -negamax(pos, depth - 1 - R, -beta, -beta + 1, false);
+        pos.UndoNullMove();
+
+        if(stopped())
+            return 0;
+
+        if(score >= beta) 
+        {
+            if(IsMate(score))
+                score = beta;
+
+            if(depth < NullVerifyDepth)
+                return score;
+
+            if(negamax(pos, depth - 1 - R, beta - 1, beta, false) >= beta)
+                return score;
+        }
+    }
+
+    Logic::Move* killers = stack[pos.GetPly()].killers;
+    MovePicker picker(pos, killers, probe.move, &history);
+
+
+    const int oldAlpha = alpha;
+    int bestScore = -Logic::INF;
+    Logic::Move bestMove;
+    int moveCount = 0;
+
+    // тихие ходы, не давшие отсечения: при отсечении их history уменьшается
+    Logic::Move quiets[Logic::MAX_MOVES_COUNT];
+    int quietCount = 0;
+
+
+    while(std::optional m = picker.next())
+    {
+        const Logic::Move& move = m.value();
+        const bool quiet = IsQuiet(pos, move);
+        // до DoMove: GivesCheck смотрит на позицию, где ход еще не сделан
+        const bool givesCheck = pos.GivesCheck(move);
+        const int newDepth = depth - 1 + (settings.checkExtensions && givesCheck && canExtend(pos));
+
+        pos.DoMove(move);
+        tt.prefetch(pos.GetHash());
+        ++moveCount;
+
+        int score;
+        // ничья по правилам - оценка этого хода, остальные ходы узла смотрим как обычно
+        if(pos.IsDraw(rootPos->GetHistory())) {
+            score = Logic::DRAW_SCORE;
+            pos.UndoMove();
+        } else {
+            eval.Update(move);
+
+            if(moveCount == 1) {
+                score = -negamax(pos, newDepth, -beta, -alpha);
+            } else {
+                // LMR: поздние тихие ходы сначала смотрим на меньшую глубину
+                int R = 0;
+                if(
+                    settings.lmr && quiet && !inCheck && !givesCheck &&
+                    depth >= LmrMinDepth && moveCount > LmrMinMoves &&
+                    move != killers[0] && move != killers[1]
+                ) {
+                    R = Reductions[std::min(depth, ReductionDepths - 1)][moveCount] - pvNode;
+                    R = std::clamp(R, 0, newDepth - 1);
+                }
+
+                score = -negamax(pos, newDepth - R, -alpha - 1, -alpha);
+                if(R && score > alpha)
+                    score = -negamax(pos, newDepth, -alpha - 1, -alpha);
+                if(score > alpha && score < beta)
+                    score = -negamax(pos, newDepth, -beta, -alpha);
+            }
+
+            pos.UndoMove();
+            eval.Rollback();
+        }
+
+        if(stopped())
+            return 0;
+
+        if(score > bestScore)
+        {
+            bestScore = score;
+            bestMove = move;
+            if(bestScore > alpha)
+            {
+                alpha = bestScore;
+                if(alpha >= beta)
+                {
+                    result.cutoffs++;
+                    result.first_move_cutoffs += moveCount == 1;
+
+                    tt.store(pos.GetHash(), bestScore, move, depth, EntryType::LowerBound, nodeEval);
+
+                    if(quiet) {
+                        if(killers[0] != move) {
+                            killers[1] = killers[0];
+                            killers[0] = move;
+                        }
+                        history.Update(pos, move, quiets, quietCount, depth);
+                    }
+
+                    return bestScore;
+                }
+            }
+        }
+
+        if(quiet)
+            quiets[quietCount++] = move;
+    }
+
+    if(!moveCount)
+        return inCheck ? -Logic::INF + pos.GetPly() : Logic::DRAW_SCORE;
+
+    if(bestScore <= oldAlpha)
+        tt.store(pos.GetHash(), bestScore, bestMove, depth, EntryType::UpperBound, nodeEval);
+    else
+        tt.store(pos.GetHash(), bestScore, bestMove, depth, EntryType::Exact, nodeEval);
+
+    return bestScore;
+}
+
+int Worker::qsearch(Logic::PositionFM& pos, int alpha, int beta, bool checks)
+{
+    if(stopped())
+        return 0;
+
+    if(pos.IsDraw(rootPos->GetHistory()))
+        return Logic::DRAW_SCORE;
+
+    countNode();
+
+    // шахи считаются от последнего хода, это дешевле статической оценки
+    pos.UpdateAttacks();
+    const bool inCheck = pos.IsCheck();
+
+    // под шахом стоять нельзя: оценка позиции не нижняя граница, перебираются все уходы
+    if(!inCheck || stackFull(pos))
+    {
+        const int score = staticEval(pos);
+
+        if(stackFull(pos))
+            return score;
+
+        if(score >= beta)
+            return beta;
+
+        if(score > alpha)
+            alpha = score;
+    }
+
+    MovePicker picker(pos, checks);
+    int moveCount = 0;
+
+
+    while(std::optional m = picker.next())
+    {
+        const Logic::Move& move = m.value();
+        ++moveCount;
+
+        pos.DoMove(move);
+        eval.Update(move);
+
+        const int score = -qsearch(pos, -beta, -alpha);
+
+        pos.UndoMove();
+        eval.Rollback();
+
+        if(score > alpha) {
+            alpha = score;
+            if(alpha >= beta)
+                return beta;
+        }
+    }
+
+    if(!moveCount && inCheck)
+        return -Logic::INF + pos.GetPly();
+
+    return alpha;
+}
+
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "eval.hpp"
+#include "evalcache.hpp"
+#include "history.hpp"
+#include "tt.hpp"
+#include "timer.hpp"
+#include "logic/move.hpp"
+#include "logic/position.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+
+namespace Core::Engine
+{
+
+/*
+Один поисковый поток (Lazy SMP).
+У каждого Worker своя позиция, стек оценки, killer-ходы и History,
+между потоками общие только таблица транспозиций, сеть NNUE, таймер и флаг остановки.
+*/
+class Worker {
+public:
+
+    struct Result {
+        long long nodes;
+        long long tt_cuts;
+        // отсечения по beta и сколько из них дал первый же ход
+        long long cutoffs;
+        long long first_move_cutoffs;
+        long long pawn_probes;
+        long long pawn_hits;
+        // запросы статической оценки и сколько из них взято из EvalCache и из TT
+        long long eval_probes;
+        long long eval_cache_hits;
+        long long eval_tt_hits;
+        int depth;
+        int eval;
+        Logic::Move bestMove;
+    };
+
+public:
+
+    // отключаемые сокращения перебора и члены оценки (для A/B сравнения)
+    struct Settings {
+        bool lmr = true;
+        bool nullMove = true;
+        bool pawnStructure = true;
+        bool evalCache = true;
+        // продление шахующих ходов и тихие шахи на первом ply qsearch
+        bool checkExtensions = true;
+        bool qsearchChecks = true;
+        // стек поиска в ply: глубина итерации плюс продолжения qsearch
+        int stackSize = Logic::DEFAULT_STACK_SIZE;
+    };
+
+public:
+
+    // network - общая для всех потоков сеть NNUE, nullptr - оценка PeSTO
+    Worker(
+        int id, const Settings& settings, Transposition& tt, const NNUE::Network* network,
+        const Timer& timer, const std::atomic<bool>& stop
+    ) noexcept
+        : id(id), settings(settings), tt(tt), timer(timer), stop(stop), 
+          eval(network, settings.pawnStructure, settings.stackSize), stack(new Ply[settings.stackSize]()) 
+    {
+        pos.ReserveStack(settings.stackSize);
+    }
+
+    bool Run(const Logic::PositionDM& rootPos, int maxDepth);
+    // вызывается из Run после каждой завершенной итерации
+    void SetOnIteration(std::function<void()> callback) {onIteration = std::move(callback);}
+    // сброс статистики сортировки ходов между партиями
+    void NewGame() noexcept;
+    const Result& GetResult() const noexcept {return result;}
+    // число узлов, которое можно читать из другого потока во время поиска (с отставанием до NodesPublishMask)
+    long long Nodes() const noexcept {return publishedNodes.load(std::memory_order_relaxed);}
+    // до старта потоков, чтобы промежуточный результат не захватил узлы прошлого поиска
+    void ResetNodes() noexcept {publishedNodes.store(0, std::memory_order_relaxed);}
+
+private:
+
+    int searchRoot(Logic::PositionFM&, int depth, int alpha, int beta, Logic::Move& bestMove);
+    int negamax(Logic::PositionFM&, int depth, int alpha, int beta, bool nullAllowed = true);
+    // checks - добавить к взятиям тихие шахи (только на первом ply qsearch)
+    int qsearch(Logic::PositionFM&, int alpha, int beta, bool checks = false);
+    // статическая оценка через EvalCache; ttEval - оценка из записи TT, если есть
+    int staticEval(const Logic::PositionFM&, std::optional<int16_t> ttEval = std::nullopt);
+
+    // переносит счетчики оценки в result
+    void collectStats() noexcept;
+
+    void countNode() noexcept {
+        if(!(++result.nodes & NodesPublishMask))
+            publishedNodes.store(result.nodes, std::memory_order_relaxed);
+    }
+
+    bool stopped() const noexcept {
+        return stop.load(std::memory_order_relaxed) || timer.TimeUp();
+    }
+
+    // из последней записи стека ход уже не сделать
+    bool stackFull(const Logic::PositionFM& pos) const noexcept {
+        return pos.GetPly() >= settings.stackSize - 1;
+    }
+
+    // продления шахов ограничены удвоенной глубиной итерации, иначе серия шахов не дает поиску закончиться
+    bool canExtend(const Logic::PositionFM& pos) const noexcept {
+        return pos.GetPly() - rootPly < 2 * rootDepth;
+    }
+
+private:
+
+    // то, что поиск хранит на ply, кроме истории позиции и стека оценки
+    struct Ply {
+        Logic::Move killers[2];
+    };
+
+private:
+
+    static constexpr long long NodesPublishMask = 1023;
+
+    const int id;
+    const Settings settings;
+    Transposition& tt;
+    const Timer& timer;
+    const std::atomic<bool>& stop;
+
+    Result result;
+    std::atomic<long long> publishedNodes = 0;
+    std::function<void()> onIteration;
+    // память под стеки (позиции, оценки, Ply) выделяется один раз на поток, в Run не выделяется
+    Logic::PositionFM pos;
+    int rootPly = 0;
+    int rootDepth = 0;
+    Evaluation eval;
+    std::unique_ptr<Ply[]> stack;
+    EvalCache evalCache;
+    History history;
+
+    const Logic::PositionDM* rootPos;
+
+};
+
+}
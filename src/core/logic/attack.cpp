@@ -2,10 +2,12 @@
 #include "bitboard.hpp"
 #include "defs.hpp"
 
+#include <stdexcept>
+
 namespace Core::Logic
 {
 
-const int RookBits[] =
+constexpr int RookBits[] =
 {
     12, 11, 11, 11, 11, 11, 11, 12,
     11, 10, 10, 10, 10, 10, 10, 11,
@@ -17,7 +19,7 @@ const int RookBits[] =
     12, 11, 11, 11, 11, 11, 11, 12
 };
 
-const int BishopBits[] =
+constexpr int BishopBits[] =
 {
     6, 5, 5, 5, 5, 5, 5, 6,
     5, 5, 5, 5, 5, 5, 5, 5,
@@ -30,31 +32,103 @@ const int BishopBits[] =
 };
 
 
-struct Magic
+// множители fancy magic под ровно RookBits/BishopBits бит индекса, найдены перебором случайных разреженных чисел
+constexpr U64 RookMagics[] =
 {
-    Magic() = default;
-    ~Magic() { delete[] magic; }
+    0x008000908064C000ULL, 0x0040200040001000ULL, 0x0180100080A0010AULL, 0x8880041000800800ULL,
+    0x1200100201200804ULL, 0x0200020004011008ULL, 0x2180010000800600ULL, 0x0200005088210204ULL,
+    0x0400800040008021ULL, 0x0400400020005000ULL, 0x8240801000200080ULL, 0x8611001004200900ULL,
+    0x008180800C001800ULL, 0x0100800200800400ULL, 0x0A02000102000408ULL, 0x8020802300104280ULL,
+    0x0080004000402000ULL, 0xE010104000402000ULL, 0x0800808010002000ULL, 0xA280210008100100ULL,
+    0x0001818014000800ULL, 0xA002010100080400ULL, 0x0080240001020870ULL, 0x0001020004048845ULL,
+    0x0081826280004004ULL, 0x2020810900284000ULL, 0x0200100080802000ULL, 0x0200080080100080ULL,
+    0x8083080100100500ULL, 0x4406000901000400ULL, 0x0005020080800100ULL, 0x0090204200008114ULL,
+    0x0010400094800420ULL, 0x0900804000802002ULL, 0x0201001841002000ULL, 0x4100080080801000ULL,
+    0x4540040080800800ULL, 0x0002001004040020ULL, 0x0281195814001002ULL, 0x1240800040800100ULL,
+    0x0880042000524004ULL, 0x02C080410206002CULL, 0x0801200241050010ULL, 0x8400080010008080ULL,
+    0x0008000500090010ULL, 0x0082009084020008ULL, 0x4012000108020004ULL, 0x9000104D08860004ULL,
+    0x2004204114800100ULL, 0x0148802112400300ULL, 0x0202842000100880ULL, 0x001B080080900080ULL,
+    0x001A002008100600ULL, 0x0004008004020080ULL, 0x5181000600040300ULL, 0x0000044401128A00ULL,
+    0x8044110480002441ULL, 0x2008110084402202ULL, 0x90806005090010C1ULL, 0x000420310A004A42ULL,
+    0x0023001004020801ULL, 0x0882001008040102ULL, 0x000230088118020CULL, 0x0000019025040042ULL
+};
 
-    Bitboard attacks;
-    Bitboard* magic;
+constexpr U64 BishopMagics[] =
+{
+    0x0020428400408200ULL, 0x2008010104210004ULL, 0x02D0009200480190ULL, 0x0018158B00010100ULL,
+    0x02C4042132048008ULL, 0x020082202000C221ULL, 0x4000421050080009ULL, 0x0210140202022020ULL,
+    0x00C0101410042248ULL, 0x0405204800D48080ULL, 0x3800C89200420002ULL, 0x180844124A020440ULL,
+    0x04403410A8002221ULL, 0x4040209004200400ULL, 0x084004020202A204ULL, 0x3010002104022000ULL,
+    0x00200240A9110900ULL, 0x2302800404080210ULL, 0x0204188800240010ULL, 0x8048000C01401200ULL,
+    0x120C001A11040900ULL, 0x0000401200500440ULL, 0x00004040840420A0ULL, 0x0020930822880804ULL,
+    0x4044401090900161ULL, 0x0034100015210804ULL, 0x8004100009010120ULL, 0x48C8080000820500ULL,
+    0x0080848004002000ULL, 0x0801004012005044ULL, 0x000080902C040400ULL, 0x0004009005004100ULL,
+    0x0B103010048A0200ULL, 0x8004100203181A00ULL, 0x0800140200100080ULL, 0x8401010800910040ULL,
+    0x0840010011290040ULL, 0x40100214202E1000ULL, 0x0842040040010840ULL, 0x0028010040010860ULL,
+    0x00080202A2051000ULL, 0x4200841008084204ULL, 0x0021120110000D02ULL, 0x48C1004208000084ULL,
+    0x0010088100414400ULL, 0x0021101000420580ULL, 0x0010040558401410ULL, 0x200C0C82A1050205ULL,
+    0x0011108820088000ULL, 0x0001011910120402ULL, 0x1580008608091248ULL, 0x8010018020880C02ULL,
+    0x20A1101032088480ULL, 0x0080100408082800ULL, 0x28100401140401C0ULL, 0x8002102200930012ULL,
+    0x4001040082080200ULL, 0x082200A498081808ULL, 0x000508610080D003ULL, 0x0052020044842402ULL,
+    0x4800A00140C84840ULL, 0x5000000848080820ULL, 0x0101086004240040ULL, 0x0028280808005014ULL
 };
 
 
-static Magic RookAttacksTable[SQUARE_COUNT];
-static Magic BishopAttacksTable[SQUARE_COUNT];
-static Bitboard KingAttacksTable[SQUARE_COUNT];
-static Bitboard KnightAttacksTable[SQUARE_COUNT];
-static Bitboard PawnAttacksTable[COLOR_COUNT][SQUARE_COUNT];
+constexpr int TableSize(const int* bits)
+{
+	int size = 0;
+	for(int sqr = 0; sqr < SQUARE_COUNT; ++sqr)
+		size += 1 << bits[sqr];
+	return size;
+}
+
+
+struct Magic
+{
+	// значимые блокеры (луч без крайнего поля)
+	Bitboard attacks;
+	U64 magic = 0;
+	// начало участка поля в таблицах SliderTables
+	uint32_t offset = 0;
+	int shift = 0;
+};
+
+/*
+Атаки слонов и ладей для всех расстановок блокеров одним непрерывным массивом,
+у каждого поля свой участок длиной 1 << bits, сначала 64 участка слонов, за ними ладьи.
+Внутри участка индекс - pext(блокеры, маска) или (блокеры * magic) >> shift,
+порядок у них разный, поэтому у каждого бэкенда свой массив с общими смещениями.
+*/
+struct SliderTables
+{
+	static constexpr int Size = TableSize(BishopBits) + TableSize(RookBits);
+
+	Magic bishop[SQUARE_COUNT];
+	Magic rook[SQUARE_COUNT];
+#ifdef SLIDER_ATTACKS_PEXT
+	alignas(64) Bitboard pextAttacks[Size];
+#endif
+#ifdef SLIDER_ATTACKS_MAGIC
+	alignas(64) Bitboard magicAttacks[Size];
+#endif
+};
+
+struct LeaperTables
+{
+	Bitboard king[SQUARE_COUNT];
+	Bitboard knight[SQUARE_COUNT];
+	Bitboard pawn[COLOR_COUNT][SQUARE_COUNT];
+};
 
 
 namespace Slow
 {
 
 template <DirectionType dir>
-Bitboard getDirAttack(Square attacker, Bitboard blockers) noexcept
+constexpr Bitboard getDirAttack(Square attacker, Bitboard blockers) noexcept
 {
 	Bitboard attacks;
-    Bitboard piece = attacker.bitboard();
+    Bitboard piece = Bitboard::FromSquares(attacker);
     Bitboard not_blocked = ~blockers;
 
     while(piece)
@@ -68,7 +142,13 @@ Bitboard getDirAttack(Square attacker, Bitboard blockers) noexcept
 }
 
 template<DirectionType... Dirs>
-Bitboard SlideAttacks(const AttackParams &p)
+constexpr Bitboard RayAttacks(Square attacker, Bitboard blockers) noexcept
+{
+	return (getDirAttack<Dirs>(attacker, blockers) | ...);
+}
+
+template<DirectionType... Dirs>
+constexpr Bitboard SlideAttacks(const AttackParams &p)
 {
 	assert(p.hasAttacker() && p.hasBlockers());
 	
@@ -88,10 +168,10 @@ Bitboard SlideAttacks(const AttackParams &p)
 		return result.value_or(Bitboard::Null());
 	}
 
-	return (getDirAttack<Dirs>(attacker, blocker) | ...);
+	return RayAttacks<Dirs...>(attacker, blocker);
 }
 
-Bitboard BishopAttack(const AttackParams &p)
+constexpr Bitboard BishopAttack(const AttackParams &p)
 {
 	return SlideAttacks
 	<
@@ -101,7 +181,7 @@ Bitboard BishopAttack(const AttackParams &p)
 	(p);
 }
 
-Bitboard RookAttack(const AttackParams &p)
+constexpr Bitboard RookAttack(const AttackParams &p)
 {
 	return SlideAttacks
 	<
@@ -111,16 +191,16 @@ Bitboard RookAttack(const AttackParams &p)
 	(p);
 }
 
-Bitboard QueenAttack(const AttackParams& p)
+constexpr Bitboard QueenAttack(const AttackParams& p)
 {
 	return BishopAttack(p) | RookAttack(p);
 }
 
-Bitboard KingAttack(const AttackParams& p)
+constexpr Bitboard KingAttack(const AttackParams& p)
 {
 	assert(p.hasAttacker());
 
-	Bitboard king = p.get_attacker().bitboard();
+	Bitboard king = Bitboard::FromSquares(p.get_attacker());
 
 	return 
 		step<NORTH>(king) |
@@ -133,12 +213,12 @@ Bitboard KingAttack(const AttackParams& p)
 		step<SOUTH_WEST>(king);
 }
 
-Bitboard KnightAttack(const AttackParams& p)
+constexpr Bitboard KnightAttack(const AttackParams& p)
 {
 	assert(p.hasAttacker());
 
 	Bitboard attacks;
-	Bitboard knight = p.get_attacker().bitboard();
+	Bitboard knight = Bitboard::FromSquares(p.get_attacker());
 
 	if (!(knight & FileType::FileH))
 	{
@@ -156,12 +236,12 @@ Bitboard KnightAttack(const AttackParams& p)
 	return attacks;
 }
 
-Bitboard PawnAttack(const AttackParams& p)
+constexpr Bitboard PawnAttack(const AttackParams& p)
 {
 	assert(p.hasAttacker() && p.hasColor());
 
 	Color clr = p.get_color();
-	Bitboard pawn = p.get_attacker().bitboard();
+	Bitboard pawn = Bitboard::FromSquares(p.get_attacker());
 
 	if(clr.is(WHITE)) {
 		return 
@@ -180,29 +260,172 @@ Bitboard PawnAttack(const AttackParams& p)
 }
 
 
-namespace Fast
+namespace SetAttacks
 {
 
-inline Bitboard SlideAttacks(Magic* table, const AttackParams &p)
+using AttackPtr = Bitboard(*)(const AttackParams&);
+
+// лучи берутся напрямую, без AttackParams: иначе ладейная таблица упирается в лимит constexpr вычислений
+template<DirectionType... Dirs>
+constexpr uint32_t Slide(SliderTables& t, Magic* magics, const int* bits, const U64* numbers, uint32_t offset)
 {
-	assert(p.hasAttacker() && p.hasBlockers());
+	for(Square sqr = Square::Start(); sqr < SQUARE_COUNT; ++sqr)
+	{
+		Magic& magic = magics[sqr];
+
+		magic.offset = offset;
+		magic.magic = numbers[sqr];
+		magic.shift = 64 - bits[sqr];
+		magic.attacks = Slow::RayAttacks<Dirs...>(sqr, Bitboard::Null());
+
+		const Bitboard b = Bitboard::FromSquares(sqr);
+		if(b & FileType::NotFileA) magic.attacks &= FileType::NotFileA;
+		if(b & FileType::NotFileH) magic.attacks &= FileType::NotFileH;
+		if(b & RankType::NotRank1) magic.attacks &= RankType::NotRank1;
+		if(b & RankType::NotRank8) magic.attacks &= RankType::NotRank8;
+
+		// поля маски по возрастанию: i-й бит номера расстановки - i-е поле, как в pdep
+		Square mask[12];
+		int count = 0;
+		for(Square s = Square::Start(); s < SQUARE_COUNT; ++s)
+			if(magic.attacks & Bitboard::FromSquares(s))
+				mask[count++] = s;
+
+		assert(count == bits[sqr]);
+
+		Bitboard blockers;
+		for(int block_sqrs_num = 0; block_sqrs_num < (1 << count); ++block_sqrs_num)
+		{
+			const Bitboard attacks = Slow::RayAttacks<Dirs...>(sqr, blockers);
+#ifdef SLIDER_ATTACKS_PEXT
+			t.pextAttacks[offset + block_sqrs_num] = attacks;
+#endif
+#ifdef SLIDER_ATTACKS_MAGIC
+			t.magicAttacks[offset + magic_index(blockers, magic.magic, magic.shift)] = attacks;
+#endif
+
+			// +1 к номеру: младшие единицы гасятся, следующий ноль становится единицей
+			for(int i = 0; i < count; ++i) {
+				blockers ^= Bitboard::FromSquares(mask[i]);
+				if(!(block_sqrs_num & (1 << i)))
+					break;
+			}
+		}
 
-	Square attacker = p.get_attacker();
+		offset += 1 << count;
+	}
+
+	return offset;
+}
+
+constexpr void NonSlide(AttackPtr slow, Bitboard* attack_table, AttackParams& p)
+{
+	for(Square sqr = Square::Start(); sqr < SQUARE_COUNT; ++sqr) {
+		p.set_attacker(sqr);
+		attack_table[sqr] = slow(p);
+	}
+}
+
+constexpr SliderTables MakeSliderTables()
+{
+	SliderTables t{};
 
-	Bitboard blocked = p.get_blockers() & table[attacker].attacks;
-    int key = pext(blocked, table[attacker].attacks);
+	const uint32_t offset = Slide<SOUTH_EAST, SOUTH_WEST, NORTH_EAST, NORTH_WEST>(t, t.bishop, BishopBits, BishopMagics, 0);
+	Slide<EAST, WEST, NORTH, SOUTH>(t, t.rook, RookBits, RookMagics, offset);
 
-	return table[attacker].magic[key];
+	return t;
+}
+
+constexpr LeaperTables MakeLeaperTables()
+{
+	LeaperTables t{};
+	AttackParams p;
+
+	NonSlide(&Slow::KingAttack, t.king, p);
+	NonSlide(&Slow::KnightAttack, t.knight, p);
+
+	for(Color clr(WHITE); clr.isValid(); clr.next()) {
+		p.set_color(clr);
+		NonSlide(&Slow::PawnAttack, t.pawn[clr], p);
+	}
+
+	return t;
+}
+
+}
+
+
+// считаются при компиляции и лежат в секции констант: ни аллокаций, ни работы при старте
+constexpr SliderTables Sliders = SetAttacks::MakeSliderTables();
+constexpr LeaperTables Leapers = SetAttacks::MakeLeaperTables();
+
+
+namespace Backend
+{
+
+#ifdef SLIDER_ATTACKS_PEXT
+constexpr bool HasPext = true;
+#else
+constexpr bool HasPext = false;
+#endif
+
+#ifdef SLIDER_ATTACKS_MAGIC
+constexpr bool HasMagic = true;
+#else
+constexpr bool HasMagic = false;
+#endif
+
+SliderBackend Detect() noexcept
+{
+	if constexpr (!HasPext)
+		return SliderBackend::Magic;
+	if constexpr (!HasMagic)
+		return SliderBackend::Pext;
+
+#if defined (__GNUC__)
+	// вызывается при статической инициализации, cpuid libgcc может быть еще не заполнен
+	__builtin_cpu_init();
+	// на Zen1/Zen2 pext выполняется микрокодом за десятки тактов;
+	// наличие BMI2 не проверяем: с pext весь Logic_lib собран с -mbmi2, без него нужен MAGIC
+	if(__builtin_cpu_is("znver1") || __builtin_cpu_is("znver2"))
+		return SliderBackend::Magic;
+#endif
+	return SliderBackend::Pext;
+}
+
+static SliderBackend Current = Detect();
+
+}
+
+
+namespace Fast
+{
+
+inline Bitboard SlideAttacks(const Magic* table, const AttackParams &p)
+{
+	assert(p.hasAttacker() && p.hasBlockers());
+
+	const Magic& magic = table[p.get_attacker()];
+	const Bitboard blocked = p.get_blockers() & magic.attacks;
+
+	// при сборке с одним бэкендом ветка сворачивается при компиляции
+#ifdef SLIDER_ATTACKS_PEXT
+	if(!Backend::HasMagic || Backend::Current == SliderBackend::Pext)
+		return Sliders.pextAttacks[magic.offset + pext(blocked, magic.attacks)];
+#endif
+#ifdef SLIDER_ATTACKS_MAGIC
+	return Sliders.magicAttacks[magic.offset + magic_index(blocked, magic.magic, magic.shift)];
+#endif
 }
 	
 Bitboard BishopAttack(const AttackParams &p)
 {
-	return SlideAttacks(BishopAttacksTable, p);
+	return SlideAttacks(Sliders.bishop, p);
 }
 
 Bitboard RookAttack(const AttackParams &p)
 {
-	return SlideAttacks(RookAttacksTable, p);
+	return SlideAttacks(Sliders.rook, p);
 }
 
 Bitboard QueenAttack(const AttackParams& p)
@@ -213,84 +436,39 @@ Bitboard QueenAttack(const AttackParams& p)
 Bitboard KingAttack(const AttackParams& p)
 {
 	assert(p.hasAttacker());
-	return KingAttacksTable[p.get_attacker()];
+	return Leapers.king[p.get_attacker()];
 }
 
 Bitboard KnightAttack(const AttackParams& p)
 {
 	assert(p.hasAttacker());
-	return KnightAttacksTable[p.get_attacker()];
+	return Leapers.knight[p.get_attacker()];
 }
 
 Bitboard PawnAttack(const AttackParams& p)
 {
 	assert(p.hasAttacker() && p.hasColor());
-	return PawnAttacksTable[p.get_color()][p.get_attacker()];
+	return Leapers.pawn[p.get_color()][p.get_attacker()];
 }
 
 }
 
 
-namespace SetAttacks
+bool HasSliderBackend(SliderBackend backend) noexcept
 {
-
-using AttackPtr = Bitboard(*)(const AttackParams&);
-
-void Slide(AttackPtr slow, Magic* attack_table, const int* bits)
-{
-	AttackParams params;
-
-	for(Square sqr = Square::Start(); sqr < SQUARE_COUNT; ++sqr)
-	{
-		int perms = 1 << bits[sqr];
-
-		attack_table[sqr].magic = new Bitboard[perms];
-		attack_table[sqr].attacks = slow(
-			params.set_attacker(sqr).set_blockers(0)
-		);
-
-		const Bitboard b = sqr.bitboard();
-		if(b & FileType::NotFileA) attack_table[sqr].attacks &= FileType::NotFileA;
-		if(b & FileType::NotFileH) attack_table[sqr].attacks &= FileType::NotFileH;
-		if(b & RankType::NotRank1) attack_table[sqr].attacks &= RankType::NotRank1;
-		if(b & RankType::NotRank8) attack_table[sqr].attacks &= RankType::NotRank8;
-
-		for(int block_sqrs_num = 0; block_sqrs_num < perms; ++block_sqrs_num)
-		{
-			Bitboard blockers = pdep(block_sqrs_num, attack_table[sqr].attacks);
-			int key = pext(blockers, attack_table[sqr].attacks);
-			attack_table[sqr].magic[key] = slow(
-				params.set_blockers(blockers)
-			);
-		}
-	}
+	return backend == SliderBackend::Pext ? Backend::HasPext : Backend::HasMagic;
 }
 
-void NonSlide(AttackPtr slow, Bitboard* attack_table, AttackParams& p)
+SliderBackend GetSliderBackend() noexcept
 {
-	for(Square sqr = Square::Start(); sqr < SQUARE_COUNT; ++sqr) {
-		p.set_attacker(sqr);
-		attack_table[sqr] = slow(p);
-	}
+	return Backend::Current;
 }
 
-}
-
-
-void SetupAttacks()
+void SetSliderBackend(SliderBackend backend)
 {
-	SetAttacks::Slide(&Slow::BishopAttack, BishopAttacksTable, BishopBits);
-	SetAttacks::Slide(&Slow::RookAttack, RookAttacksTable, RookBits);
-
-	AttackParams p;
-
-	SetAttacks::NonSlide(&Slow::KingAttack, KingAttacksTable, p);
-	SetAttacks::NonSlide(&Slow::KnightAttack, KnightAttacksTable, p);
-
-	for(Color clr(WHITE); clr.isValid(); clr.next()) {
-		p.set_color(clr);
-		SetAttacks::NonSlide(&Slow::PawnAttack, PawnAttacksTable[clr], p);
-	}
+	if(!HasSliderBackend(backend))
+		throw std::invalid_argument("slider attack backend is not compiled in");
+	Backend::Current = backend;
 }
 
 Bitboard GetFastAttack(Piece pt, const AttackParams &p)
@@ -18,20 +18,20 @@ class AttackParams
     using OptDIR = std::optional<DirectionType>;
 public:
     
-    AttackParams& set_attacker(Square from) noexcept {attacker = from; return *this;}
-    AttackParams& set_blockers(OptBB bb) noexcept {blockers = bb; return *this;}
-    AttackParams& set_color(OptCLR clr) noexcept {color = clr; return *this;}
-    AttackParams& set_dir(OptDIR d) noexcept {dir = d; return *this;}
+    constexpr AttackParams& set_attacker(Square from) noexcept {attacker = from; return *this;}
+    constexpr AttackParams& set_blockers(OptBB bb) noexcept {blockers = bb; return *this;}
+    constexpr AttackParams& set_color(OptCLR clr) noexcept {color = clr; return *this;}
+    constexpr AttackParams& set_dir(OptDIR d) noexcept {dir = d; return *this;}
 
-    Square get_attacker() const {return attacker;}
-    Bitboard get_blockers() const {return *blockers;}
-    Color get_color() const {return *color;}
-    DirectionType get_dir() const {return *dir;}
+    constexpr Square get_attacker() const {return attacker;}
+    constexpr Bitboard get_blockers() const {return *blockers;}
+    constexpr Color get_color() const {return *color;}
+    constexpr DirectionType get_dir() const {return *dir;}
 
-    bool hasAttacker() const noexcept {return attacker.isValid();}
-    bool hasBlockers() const noexcept {return blockers.has_value();}
-    bool hasColor() const noexcept {return color.has_value();}
-    bool hasDir() const noexcept {return dir.has_value();}
+    constexpr bool hasAttacker() const noexcept {return attacker.isValid();}
+    constexpr bool hasBlockers() const noexcept {return blockers.has_value();}
+    constexpr bool hasColor() const noexcept {return color.has_value();}
+    constexpr bool hasDir() const noexcept {return dir.has_value();}
 
 private:
 
@@ -42,7 +42,20 @@ private:
 
 };
 
-void SetupAttacks();
+// как GetFastAttack индексирует таблицы слонов и ладей
+enum class SliderBackend : uint8_t
+{
+	Pext,
+	Magic
+};
+
+// собран ли бэкенд (ATTEMPT_SLIDER_ATTACKS в CMake)
+bool HasSliderBackend(SliderBackend backend) noexcept;
+// при сборке с обоими бэкендами выбирается по cpuid при старте
+SliderBackend GetSliderBackend() noexcept;
+// для тестов и бенчмарков, бросает std::invalid_argument, если бэкенд не собран
+void SetSliderBackend(SliderBackend backend);
+
 Bitboard GetFastAttack(Piece pt, const AttackParams& ap);
 Bitboard GetSlowAttack(Piece pt, const AttackParams& ap);
 
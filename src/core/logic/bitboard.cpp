@@ -39,6 +39,9 @@ int Bitboard::count() const
 #endif	   
 }
 
+// без BMI2 (ATTEMPT_SLIDER_ATTACKS=MAGIC) инструкций нет, и pext/pdep не используются
+#if defined(__BMI2__) || defined(_MSC_VER)
+
 int pext(
 	const Bitboard &blockers, 
 	const Bitboard &attacks
@@ -53,6 +56,8 @@ Bitboard pdep(
     return Bitboard(_pdep_u64(num, attacks.bb)); 
 }
 
+#endif
+
 void Bitboard::print() const
 {
 	for (int i = 7; i >= 0; i--)
@@ -28,12 +28,12 @@ public:
     constexpr Bitboard(uint64_t bb)         noexcept : bb(bb) {}
     constexpr Bitboard(const Bitboard& b)   noexcept : bb(b.bb) {}
 
-    Bitboard& operator  =   (const Bitboard& b) noexcept {bb = b.bb; return *this;}
-    Bitboard& operator  |=  (const Bitboard& b) noexcept {bb |= b.bb; return *this;}
-    Bitboard& operator  &=  (const Bitboard& b) noexcept {bb &= b.bb; return *this;}
-    Bitboard& operator  <<= (int num) noexcept {bb <<= num; return *this;}
-    Bitboard& operator  >>= (int num) noexcept {bb >>= num; return *this;}
-    Bitboard& operator  ^=  (const Bitboard& b) noexcept {bb ^= b.bb; return *this;}
+    constexpr Bitboard& operator  =   (const Bitboard& b) noexcept {bb = b.bb; return *this;}
+    constexpr Bitboard& operator  |=  (const Bitboard& b) noexcept {bb |= b.bb; return *this;}
+    constexpr Bitboard& operator  &=  (const Bitboard& b) noexcept {bb &= b.bb; return *this;}
+    constexpr Bitboard& operator  <<= (int num) noexcept {bb <<= num; return *this;}
+    constexpr Bitboard& operator  >>= (int num) noexcept {bb >>= num; return *this;}
+    constexpr Bitboard& operator  ^=  (const Bitboard& b) noexcept {bb ^= b.bb; return *this;}
 
     constexpr Bitboard operator   |   (const Bitboard& b) const noexcept {return Bitboard(bb | b.bb);}
     constexpr Bitboard operator   &   (const Bitboard& b) const noexcept {return Bitboard(bb & b.bb);}
@@ -42,8 +42,8 @@ public:
     constexpr Bitboard operator   ~   () const noexcept {return Bitboard(~bb);}
     constexpr Bitboard operator   ^   (const Bitboard& b) const noexcept {return Bitboard(bb ^ b.bb);}
 
-    bool operator == (const Bitboard& b) const noexcept {return bb == b.bb;}
-    bool operator != (const Bitboard& b) const noexcept {return bb != b.bb;}
+    constexpr bool operator == (const Bitboard& b) const noexcept {return bb == b.bb;}
+    constexpr bool operator != (const Bitboard& b) const noexcept {return bb != b.bb;}
 
     constexpr operator bool() const noexcept {return bb != 0;}
     constexpr bool operator ! () const noexcept {return bb == 0;}
@@ -55,6 +55,10 @@ public:
 
     friend int pext(const Bitboard& blockers, const Bitboard& attacks);
     friend Bitboard pdep(int num, const Bitboard& attacks);
+    // индекс fancy magic: (blockers * magic) >> shift
+    friend constexpr int magic_index(const Bitboard& blockers, uint64_t magic, int shift) noexcept {
+        return int((blockers.bb * magic) >> shift);
+    }
 
     void print() const;
 
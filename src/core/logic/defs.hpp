@@ -16,7 +16,9 @@ constexpr int CASTLE_COUNT = 63;
 constexpr int SQUARE_COUNT = 64;
 constexpr int MAX_MOVES_COUNT = 218;
 constexpr int MAX_REPETITIONS = 3;
-constexpr int MAX_HISTORY_SIZE = 50;
+// стек поиска в ply: размер задается настройкой поиска, MAX_PLY - верхняя граница (и запас для оценок мата)
+constexpr int DEFAULT_STACK_SIZE = 256;
+constexpr int MAX_PLY = 1024;
 constexpr int INF = 10000;
 constexpr int DRAW_SCORE = 0;
 
@@ -240,7 +242,7 @@ public:
 
 
 template<DirectionType dir>
-Bitboard step(Bitboard b) noexcept
+constexpr Bitboard step(Bitboard b) noexcept
 {
 	if constexpr (dir == NORTH) b <<= 8;
 	if constexpr (dir == SOUTH) b >>= 8;
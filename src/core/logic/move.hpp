@@ -52,6 +52,7 @@ class ExtMove : public Move
 public:
 
     constexpr void setScore(int s) noexcept { score = s; }
+    constexpr int getScore() const noexcept { return score; }
     constexpr bool operator < (const ExtMove& m) const noexcept {return score < m.score;}
 
 private:
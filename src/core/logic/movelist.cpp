@@ -13,15 +13,76 @@ namespace
 {
 
 constexpr auto prom_list = {Q_PROMOTION_MF, K_PROMOTION_MF, B_PROMOTION_MF, R_PROMOTION_MF};
-enum class MoveType {All, Force, Dodge};
+enum class MoveType {All, Force, Dodge, Quiet};
+
+/*
+Куда генераторы отдают ходы: MoveWriter записывает их в список,
+MoveCounter только считает (популяционным счетом целевых полей, без записи ходов).
+Генераторы ниже общие для обоих, так что count и generate не расходятся.
+*/
+struct MoveWriter 
+{
+    Move* curr;
 
-void add(Square from, Square targ, MoveFlag flag, Move*& curr) {
-    *curr = Move(from, targ, flag); 
-    curr++;
-}
+    void add(Square from, Square targ, MoveFlag flag) noexcept {
+        *curr++ = Move(from, targ, flag);
+    }
+    void add_targets(Square from, Bitboard targets, MoveFlag flag) noexcept {
+        while(targets)
+            add(from, targets.poplsb(), flag);
+    }
+    void add_pawns(Bitboard targets, std::initializer_list<MoveFlag> flags, int offset_from) noexcept {
+        while(targets) {
+            Square targ = targets.poplsb();
+            Square from = targ - offset_from;
+            for(MoveFlag flag : flags)
+                add(from, targ, flag);
+        }
+    }
+};
+
+struct MoveCounter 
+{
+    size_t count = 0;
 
-template<StorageType ST>
-void piece_moves(const Position<ST>& pos, Move*& curr, Bitboard target) 
+    void add(Square, Square, MoveFlag) noexcept {
+        count++;
+    }
+    void add_targets(Square, Bitboard targets, MoveFlag) noexcept {
+        count += targets.count();
+    }
+    void add_pawns(Bitboard targets, std::initializer_list<MoveFlag> flags, int) noexcept {
+        count += targets.count() * flags.size();
+    }
+};
+
+// пропускает в Out только ходы, дающие шах
+template<typename Out, StorageType ST>
+struct CheckFilter 
+{
+    const Position<ST>& pos;
+    Out& out;
+
+    void add(Square from, Square targ, MoveFlag flag) noexcept {
+        if(pos.GivesCheck(Move(from, targ, flag)))
+            out.add(from, targ, flag);
+    }
+    void add_targets(Square from, Bitboard targets, MoveFlag flag) noexcept {
+        while(targets)
+            add(from, targets.poplsb(), flag);
+    }
+    void add_pawns(Bitboard targets, std::initializer_list<MoveFlag> flags, int offset_from) noexcept {
+        while(targets) {
+            Square targ = targets.poplsb();
+            Square from = targ - offset_from;
+            for(MoveFlag flag : flags)
+                add(from, targ, flag);
+        }
+    }
+};
+
+template<typename Out, StorageType ST>
+void piece_moves(const Position<ST>& pos, Out& out, Bitboard target) 
 {
     const Color us = pos.GetSide();
     AttackParams ap; ap.set_blockers(
@@ -45,44 +106,43 @@ void piece_moves(const Position<ST>& pos, Move*& curr, Bitboard target)
         if(Bitboard pin_mask = pos.GetPinMask(from)) 
             moves &= pin_mask;
 
-        while(moves) 
-            add(from, moves.poplsb(), DEFAULT_MF, curr);
+        out.add_targets(from, moves, DEFAULT_MF);
     }
 }
 
-template<MoveType MT, StorageType T>
-void king_moves(const Position<T> &pos, Move*& curr, Bitboard target)
+template<MoveType MT, typename Out, StorageType T>
+void king_moves(const Position<T> &pos, Out& out, Bitboard target)
 {
     const Color     us              =   pos.GetSide();
     const Square    ksq             =   pos.GetPieces(us, KING).lsb();
-    const Bitboard  enemy_attacks   =   pos.GetAttackers();
 
-    Bitboard moves = GetFastAttack(KING, AttackParams{}.set_attacker(ksq)) & ~enemy_attacks & target;
-    while(moves)
-        add(ksq, moves.poplsb(), DEFAULT_MF, curr);
+    Bitboard moves = GetFastAttack(KING, AttackParams{}.set_attacker(ksq)) & target;
 
-    if constexpr (MT != MoveType::All) 
+    // взятий королем обычно 0-1, их поля проверяются по одному без карты атак соперника
+    if constexpr (MT == MoveType::Force) {
+        const Bitboard occ = pos.GetOccupied(WHITE, BLACK) ^ ksq.bitboard();
+        for(Bitboard captures = moves; captures; ) {
+            const Square targ = captures.poplsb();
+            if(pos.GetEnemyAttackersTo(targ, occ))
+                moves ^= targ.bitboard();
+        }
+    } else if(moves) {
+        moves &= ~pos.GetAttackers();
+    }
+
+    out.add_targets(ksq, moves, DEFAULT_MF);
+
+    if constexpr (MT != MoveType::All && MT != MoveType::Quiet) 
         return;
 
     if(pos.CanCastle(KING_SIDE_CASTLING)) 
-        add(ksq, ksq + 2 * EAST, S_CASTLE_MF, curr);
+        out.add(ksq, ksq + 2 * EAST, S_CASTLE_MF);
     if(pos.CanCastle(QUEEN_SIDE_CASTLING)) 
-        add(ksq, ksq + 2 * WEST, L_CASTLE_MF, curr);
+        out.add(ksq, ksq + 2 * WEST, L_CASTLE_MF);
 }
 
-void pawn_move_generic(Bitboard moves, std::initializer_list<MoveFlag> flags, int offset_from, Move*& curr) 
-{
-    while(moves)
-    {
-        Square targ = moves.poplsb();
-        Square from = targ - offset_from;
-        for(MoveFlag flag : flags)
-            add(from, targ, flag, curr);
-    }
-}
-
-template <ColorType Us, bool Pinned, StorageType T>
-void en_passant_moves(Bitboard pawns, const Position<T>& pos, Move*& curr)
+template <ColorType Us, bool Pinned, typename Out, StorageType T>
+void en_passant_moves(Bitboard pawns, const Position<T>& pos, Out& out)
 {
     if(pos.GetPassant() == NO_SQUARE)
         return;
@@ -117,19 +177,20 @@ void en_passant_moves(Bitboard pawns, const Position<T>& pos, Move*& curr)
                 continue;
         }
 
-        add(from, passant, EN_PASSANT_MF, curr);
+        out.add(from, passant, EN_PASSANT_MF);
     }
 }
 
-template <MoveType MT, ColorType Us, StorageType T>
-void pinned_pawn_moves(Bitboard pawns, const Position<T>& pos, Move*& curr, Bitboard enemy, Bitboard empty)
+template <MoveType MT, ColorType Us, typename Out, StorageType T>
+void pinned_pawn_moves(Bitboard pawns, const Position<T>& pos, Out& out, Bitboard enemy, Bitboard empty)
 {
     constexpr ColorType     Them    =   (Us == WHITE) ? BLACK : WHITE;
     constexpr DirectionType Up      =   (Us == WHITE) ? NORTH : SOUTH;
     constexpr Bitboard      TRank3  =   (Us == WHITE) ? RankType::Rank3 : RankType::Rank6;
     constexpr Bitboard      TRank8  =   (Us == WHITE) ? RankType::Rank8 : RankType::Rank1;
     
-    en_passant_moves<Us, true>(pawns, pos, curr);
+    if constexpr (MT != MoveType::Quiet)
+        en_passant_moves<Us, true>(pawns, pos, out);
 
     AttackParams ap; 
     ap.set_color(Us);
@@ -139,7 +200,7 @@ void pinned_pawn_moves(Bitboard pawns, const Position<T>& pos, Move*& curr, Bitb
         Square from = pawns.poplsb();
         Bitboard pin_mask = pos.GetPinMask(from);
 
-        if constexpr(MT == MoveType::All)
+        if constexpr(MT == MoveType::All || MT == MoveType::Quiet)
         {    
             Bitboard single_up = step<Up>(from.bitboard()) & empty;
             Bitboard double_up = step<Up>(single_up & TRank3) & empty;
@@ -147,25 +208,28 @@ void pinned_pawn_moves(Bitboard pawns, const Position<T>& pos, Move*& curr, Bitb
             double_up &= pin_mask;
             
             if(single_up) 
-                add(from, single_up.lsb(), DEFAULT_MF, curr);
+                out.add(from, single_up.lsb(), DEFAULT_MF);
             if(double_up)
-                add(from, double_up.lsb(), DOUBLE_MF, curr);
+                out.add(from, double_up.lsb(), DOUBLE_MF);
         }
 
+        if constexpr (MT == MoveType::Quiet)
+            continue;
+
         Bitboard captures = GetFastAttack(PAWN, ap.set_attacker(from)) & enemy & pin_mask;
 
         if(captures & TRank8) {
             Square targ = captures.lsb();
             for(MoveFlag prom : prom_list) 
-                add(from, targ, prom, curr);
+                out.add(from, targ, prom);
         }
         else if(captures) 
-            add(from, captures.lsb(), DEFAULT_MF, curr); 
+            out.add(from, captures.lsb(), DEFAULT_MF); 
     }
 }
 
-template<MoveType MT, ColorType Us, StorageType T>
-void pawn_moves(const Position<T> &pos, Move*& curr)
+template<MoveType MT, ColorType Us, typename Out, StorageType T>
+void pawn_moves(const Position<T> &pos, Out& out)
 {
     constexpr ColorType     Them        =   (Us == WHITE) ? BLACK : WHITE;
     constexpr DirectionType Up          =   (Us == WHITE) ? NORTH : SOUTH;
@@ -183,7 +247,7 @@ void pawn_moves(const Position<T> &pos, Move*& curr)
     pawns ^= pinned;
 
     if constexpr (MT != MoveType::Dodge)
-        pinned_pawn_moves<MT, Us>(pinned, pos, curr, enemy, empty);
+        pinned_pawn_moves<MT, Us>(pinned, pos, out, enemy, empty);
 
 
     Bitboard single_up = step<Up>(pawns) & empty;
@@ -194,7 +258,12 @@ void pawn_moves(const Position<T> &pos, Move*& curr)
             Bitboard defense = pos.GetDeffensiveSquares();
             single_up &= defense, double_up &= defense;
         }
-        pawn_move_generic(double_up, {DOUBLE_MF}, 2 * Up, curr);
+        out.add_pawns(double_up, {DOUBLE_MF}, 2 * Up);
+    }
+
+    if constexpr (MT == MoveType::Quiet) {
+        out.add_pawns(single_up & ~TRank8, {DEFAULT_MF}, Up);
+        return;
     }
 
     Bitboard capture_left   = step<Left>(pawns) & enemy;
@@ -210,63 +279,117 @@ void pawn_moves(const Position<T> &pos, Move*& curr)
     Bitboard prom_right = capture_right & TRank8;   capture_right  ^=  prom_right;
 
     if constexpr (MT != MoveType::Force)
-        pawn_move_generic(single_up, {DEFAULT_MF}, Up, curr);
+        out.add_pawns(single_up, {DEFAULT_MF}, Up);
 
-    pawn_move_generic(capture_left, {DEFAULT_MF}, Left, curr);
-    pawn_move_generic(capture_right, {DEFAULT_MF}, Right, curr);
-    pawn_move_generic(prom_up, prom_list, Up, curr);
-    pawn_move_generic(prom_left, prom_list, Left, curr);
-    pawn_move_generic(prom_right, prom_list, Right, curr);
+    out.add_pawns(capture_left, {DEFAULT_MF}, Left);
+    out.add_pawns(capture_right, {DEFAULT_MF}, Right);
+    out.add_pawns(prom_up, prom_list, Up);
+    out.add_pawns(prom_left, prom_list, Left);
+    out.add_pawns(prom_right, prom_list, Right);
 
 
-    en_passant_moves<Us, false>(pawns, pos, curr);
+    en_passant_moves<Us, false>(pawns, pos, out);
 }
 
-template<MoveType MT, StorageType T>
-void pawn_moves(const Position<T> &pos, Move*& curr, Color us)
+template<MoveType MT, typename Out, StorageType T>
+void pawn_moves(const Position<T> &pos, Out& out, Color us)
 {
     us.is(WHITE) 
-        ? pawn_moves<MT, WHITE>(pos, curr) 
-        : pawn_moves<MT, BLACK>(pos, curr);
-}
-
+        ? pawn_moves<MT, WHITE>(pos, out) 
+        : pawn_moves<MT, BLACK>(pos, out);
 }
 
-template<MoveGenType MGT, StorageType ST>
-void MoveList::generate(const Position<ST> &pos)
+template<MoveGenType MGT, typename Out, StorageType ST>
+void generate_moves(const Position<ST> &pos, Out& out)
 {
+    if constexpr (MGT == MoveGenType::QuietChecks) {
+        CheckFilter<Out, ST> checks{pos, out};
+        generate_moves<MoveGenType::Quiet>(pos, checks);
+        return;
+    }
+
     const Color us = pos.GetSide();
     const Color opp = us.opp();
     constexpr bool IsForced = MGT == MoveGenType::Forced;
-    curr = moves;
+    constexpr bool IsQuiet = MGT == MoveGenType::Quiet;
     Bitboard target = ~pos.GetOccupied(us);
 
+    // под шахом все уходы генерирует Forced
+    if constexpr (IsQuiet) {
+        if(pos.IsCheck()) 
+            return;
+        target &= ~pos.GetOccupied(opp);
+    }
+
     if(!pos.IsDoubleCheck()) 
     {
         if(pos.IsCheck()) {
-            piece_moves(pos, curr, target & pos.GetDeffensiveSquares());
-            pawn_moves<MoveType::Dodge>(pos, curr, us);
+            piece_moves(pos, out, target & pos.GetDeffensiveSquares());
+            pawn_moves<MoveType::Dodge>(pos, out, us);
         }         
         else if constexpr (IsForced) {
-            piece_moves(pos, curr, target & pos.GetOccupied(opp));
-            pawn_moves<MoveType::Force>(pos, curr, us);
+            piece_moves(pos, out, target & pos.GetOccupied(opp));
+            pawn_moves<MoveType::Force>(pos, out, us);
+        }
+        else if constexpr (IsQuiet) {
+            piece_moves(pos, out, target);
+            pawn_moves<MoveType::Quiet>(pos, out, us);
         }
         else {
-            piece_moves(pos, curr, target);
-            pawn_moves<MoveType::All>(pos, curr, us);
+            piece_moves(pos, out, target);
+            pawn_moves<MoveType::All>(pos, out, us);
         }
     }
 
-    if(pos.IsCheck()) king_moves<MoveType::Dodge>(pos, curr, target);
-    else if constexpr(IsForced) king_moves<MoveType::Force>(pos, curr, target & pos.GetOccupied(opp));
-    else king_moves<MoveType::All>(pos, curr, target);
+    if(pos.IsCheck()) king_moves<MoveType::Dodge>(pos, out, target);
+    else if constexpr(IsForced) king_moves<MoveType::Force>(pos, out, target & pos.GetOccupied(opp));
+    else if constexpr(IsQuiet) king_moves<MoveType::Quiet>(pos, out, target);
+    else king_moves<MoveType::All>(pos, out, target);
+}
+
+}
+
+template<MoveGenType MGT, StorageType ST>
+void MoveList::generate(const Position<ST> &pos)
+{
+    MoveWriter out{moves};
+    generate_moves<MGT>(pos, out);
+    curr = out.curr;
+}
+
+template<MoveGenType MGT, StorageType ST>
+size_t MoveList::count(const Position<ST> &pos)
+{
+    MoveCounter out;
+    generate_moves<MGT>(pos, out);
+    return out.count;
 }
 
 
 template void MoveList::generate<MoveGenType::Forced, DynamicStorage>(const Position<DynamicStorage>&);
 template void MoveList::generate<MoveGenType::All, DynamicStorage>(const Position<DynamicStorage>&);
+template void MoveList::generate<MoveGenType::Quiet, DynamicStorage>(const Position<DynamicStorage>&);
+template void MoveList::generate<MoveGenType::QuietChecks, DynamicStorage>(const Position<DynamicStorage>&);
 template void MoveList::generate<MoveGenType::Forced, StaticStorage>(const Position<StaticStorage>&);
 template void MoveList::generate<MoveGenType::All, StaticStorage>(const Position<StaticStorage>&);
+template void MoveList::generate<MoveGenType::Quiet, StaticStorage>(const Position<StaticStorage>&);
+template void MoveList::generate<MoveGenType::QuietChecks, StaticStorage>(const Position<StaticStorage>&);
+template void MoveList::generate<MoveGenType::Forced, CopyStorage>(const Position<CopyStorage>&);
+template void MoveList::generate<MoveGenType::All, CopyStorage>(const Position<CopyStorage>&);
+template void MoveList::generate<MoveGenType::Quiet, CopyStorage>(const Position<CopyStorage>&);
+template void MoveList::generate<MoveGenType::QuietChecks, CopyStorage>(const Position<CopyStorage>&);
+template size_t MoveList::count<MoveGenType::Forced, DynamicStorage>(const Position<DynamicStorage>&);
+template size_t MoveList::count<MoveGenType::All, DynamicStorage>(const Position<DynamicStorage>&);
+template size_t MoveList::count<MoveGenType::Quiet, DynamicStorage>(const Position<DynamicStorage>&);
+template size_t MoveList::count<MoveGenType::QuietChecks, DynamicStorage>(const Position<DynamicStorage>&);
+template size_t MoveList::count<MoveGenType::Forced, StaticStorage>(const Position<StaticStorage>&);
+template size_t MoveList::count<MoveGenType::All, StaticStorage>(const Position<StaticStorage>&);
+template size_t MoveList::count<MoveGenType::Quiet, StaticStorage>(const Position<StaticStorage>&);
+template size_t MoveList::count<MoveGenType::QuietChecks, StaticStorage>(const Position<StaticStorage>&);
+template size_t MoveList::count<MoveGenType::Forced, CopyStorage>(const Position<CopyStorage>&);
+template size_t MoveList::count<MoveGenType::All, CopyStorage>(const Position<CopyStorage>&);
+template size_t MoveList::count<MoveGenType::Quiet, CopyStorage>(const Position<CopyStorage>&);
+template size_t MoveList::count<MoveGenType::QuietChecks, CopyStorage>(const Position<CopyStorage>&);
 
 
 
@@ -7,7 +7,12 @@
 namespace Core::Logic
 {
 
-enum class MoveGenType {All, Forced};
+/*
+Forced - взятия и превращения, под шахом - все уходы от шаха.
+Quiet - остальные ходы (вне шаха), так что Forced + Quiet = All.
+QuietChecks - те из Quiet, что дают шах (для qsearch).
+*/
+enum class MoveGenType {All, Forced, Quiet, QuietChecks};
 
 class MoveList
 {
@@ -15,6 +20,9 @@ public:
 
     template<MoveGenType MGT, StorageType ST>
     void generate(const Position<ST>& p);
+    // число ходов, которое дал бы generate, без записи самих ходов (perft, подвижность)
+    template<MoveGenType MGT, StorageType ST>
+    static size_t count(const Position<ST>& p);
 
     bool empty() const noexcept {return get_size() == 0;}
     size_t get_size() const noexcept {return curr - moves;}
@@ -11,7 +11,6 @@ void PositionBase::Setup()
 {
     static bool init = false;
     if(!init) {
-        SetupAttacks();
         Square::Setup();
         Zobrist::Setup();
         init = true;
@@ -35,10 +34,12 @@ void PositionBase::AddPiece(Color color, Piece piece, Square sqr) noexcept
     types[sqr] = piece;
 }
 
-void PositionBase::AddPiece(Color color, Piece piece, Square sqr, Zobrist &hash) noexcept
+void PositionBase::AddPiece(Color color, Piece piece, Square sqr, State &st) noexcept
 {
     AddPiece(color, piece, sqr);
-    hash.updateSquare(color, piece, sqr);
+    st.hash.updateSquare(color, piece, sqr);
+    if(piece.is(PAWN))
+        st.pawnHash.updateSquare(color, piece, sqr);
 }
 
 Piece PositionBase::RemovePiece(Color color, Square sqr) noexcept 
@@ -55,10 +56,12 @@ Piece PositionBase::RemovePiece(Color color, Square sqr) noexcept
     return piece;
 }
 
-void PositionBase::RemovePiece(Color color, Square sqr, Zobrist &hash) noexcept 
+void PositionBase::RemovePiece(Color color, Square sqr, State &st) noexcept 
 {
     Piece piece = RemovePiece(color, sqr);
-    hash.updateSquare(color, piece, sqr);
+    st.hash.updateSquare(color, piece, sqr);
+    if(piece.is(PAWN))
+        st.pawnHash.updateSquare(color, piece, sqr);
 }
 
 Piece PositionBase::MovePiece(Square from, Square targ) noexcept 
@@ -76,12 +79,16 @@ Piece PositionBase::MovePiece(Square from, Square targ) noexcept
     return piece;
 }
 
-void PositionBase::MovePiece(Square from, Square targ, Zobrist &hash) noexcept 
+void PositionBase::MovePiece(Square from, Square targ, State &st) noexcept 
 {
     Piece piece = MovePiece(from, targ);
-    hash    
+    st.hash    
         .updateSquare(side, piece, from)
         .updateSquare(side, piece, targ);
+    if(piece.is(PAWN))
+        st.pawnHash
+            .updateSquare(side, piece, from)
+            .updateSquare(side, piece, targ);
 }
 
 Piece PositionBase::ReplacePiece(Piece new_piece, Square sqr) noexcept 
@@ -98,12 +105,14 @@ Piece PositionBase::ReplacePiece(Piece new_piece, Square sqr) noexcept
     return old_piece;
 }
 
-void PositionBase::ReplacePiece(Piece new_piece, Square sqr, Zobrist &hash) noexcept 
+void PositionBase::ReplacePiece(Piece new_piece, Square sqr, State &st) noexcept 
 {
     Piece old_piece = ReplacePiece(new_piece, sqr);
-    hash 
+    st.hash 
         .updateSquare(side, old_piece, sqr)
         .updateSquare(side, new_piece, sqr);
+    // превращается всегда пешка
+    st.pawnHash.updateSquare(side, old_piece, sqr);
 }
 
 bool PositionAttacks::CanPassant(Square from, Square targ) const noexcept 
@@ -166,88 +175,213 @@ Bitboard PositionAttacks::GetAttacksTo(Square sqr, Bitboard occ) const noexcept
     return attacks;
 }
 
-void PositionAttacks::UpdateAttacks() noexcept 
+Bitboard PositionAttacks::GetEnemyAttackersTo(Square sqr, Bitboard occ) const noexcept 
 {
-    ComputePins();
-    ComputeAttacks();
+    const Color opp = side.opp();
+
+    AttackParams params;
+    params
+        .set_attacker(sqr)
+        .set_blockers(occ)
+        .set_color(side);
+
+    return 
+        (GetFastAttack(PAWN, params) & GetPieces(opp, PAWN)) |
+        (GetFastAttack(KNIGHT, params) & GetPieces(opp, KNIGHT)) |
+        (GetFastAttack(BISHOP, params) & GetPieces(opp, BISHOP, QUEEN)) |
+        (GetFastAttack(ROOK, params) & GetPieces(opp, ROOK, QUEEN)) |
+        (GetFastAttack(KING, params) & GetPieces(opp, KING));
 }
 
-void PositionAttacks::ComputePins() noexcept 
+void PositionAttacks::ComputeAttackInfo(Move last) noexcept 
 {
-    this->pinned = Bitboard::Null();
-
-    const Color opp = side.opp();
-    const Square ksq = GetPieces(side, KING).lsb();
+    this->pinned = SliderBlockers(GetPieces(side, KING).lsb(), side.opp()) & GetOccupied(side);
+
+    // рокировка и взятие на проходе открывают линии не только через from
+    const MoveFlag flag = last.flag();
+    if(!last || flag == S_CASTLE_MF || flag == L_CASTLE_MF || flag == EN_PASSANT_MF)
+        ComputeChecks();
+    else
+        ComputeChecks(last);
+
+    ComputeDefense();
+    checksReady = true;
+    attackersReady = checkSquaresReady = false;
+}
 
+Bitboard PositionAttacks::SliderBlockers(Square ksq, Color by) const noexcept 
+{
     AttackParams attack_params;
     attack_params
         .set_blockers(Bitboard::Null())
         .set_attacker(ksq);
 
     Bitboard snipers = 
-        GetFastAttack(ROOK, attack_params) & GetPieces(opp, ROOK, QUEEN) |
-        GetFastAttack(BISHOP, attack_params) & GetPieces(opp, BISHOP, QUEEN);
+        (GetFastAttack(ROOK, attack_params) & GetPieces(by, ROOK, QUEEN)) |
+        (GetFastAttack(BISHOP, attack_params) & GetPieces(by, BISHOP, QUEEN));
     Bitboard occ = GetOccupied(WHITE, BLACK) ^ snipers;
+    Bitboard blockers;
 
     while(snipers)
     {
         Square sniper = snipers.poplsb();
         Bitboard b = between(ksq, sniper) & occ;
 
-        if(b.count() == 1 && b & GetOccupied(side)) 
-            this->pinned |= b;
+        if(b.count() == 1) 
+            blockers |= b;
     }
+
+    return blockers;
 }
 
-void PositionAttacks::ComputeAttacks() noexcept 
+void PositionAttacks::ComputeChecks() noexcept 
+{
+    this->checkers = GetEnemyAttackersTo(GetPieces(side, KING).lsb(), GetOccupied(WHITE, BLACK));
+}
+
+void PositionAttacks::ComputeChecks(Move last) noexcept 
+{
+    const Color opp = side.opp();
+    const Square ksq = GetPieces(side, KING).lsb();
+    const Square from = last.from();
+    const Square targ = last.targ();
+
+    AttackParams attack_params;
+    attack_params
+        .set_blockers(GetOccupied(WHITE, BLACK))
+        .set_attacker(ksq)
+        .set_color(side);
+
+    // прямой шах: фигура на targ (после превращения - новая) бьет короля
+    this->checkers = GetFastAttack(GetPiece(targ), attack_params) & targ.bitboard();
+
+    // вскрытый шах: освободившееся поле from лежит на одной линии с королем
+    if(const Bitboard line = line_bb(ksq, from)) 
+    {
+        const bool straight = ksq.rank() == from.rank() || ksq.file() == from.file();
+        this->checkers |= straight
+            ? GetFastAttack(ROOK, attack_params) & GetPieces(opp, ROOK, QUEEN) & line
+            : GetFastAttack(BISHOP, attack_params) & GetPieces(opp, BISHOP, QUEEN) & line;
+    }
+}
+
+void PositionAttacks::ComputeDefense() noexcept 
 {
-    this->attackers = Bitboard::Null();
-    this->checkers = Bitboard::Null();
     this->defense = Bitboard::Full();
 
+    const Square ksq = GetPieces(side, KING).lsb();
+
+    for(Bitboard remaining = checkers; remaining; )
+    {
+        Square from = remaining.poplsb();
+        Piece type = GetPiece(from);
+        this->defense &= type.is(KNIGHT) || type.is(PAWN) 
+                         ? from.bitboard() 
+                         : between(ksq, from);
+    }
+}
+
+void PositionAttacks::ComputeAttackers() const noexcept 
+{
+    this->attackers = Bitboard::Null();
+
     const Color opp = side.opp();
 
     Bitboard    pawns   = GetPieces(opp, PAWN);
     Bitboard    pieces  = GetOccupied(opp) ^ pawns;
     Bitboard    king    = GetPieces(side, KING);
-    Square      ksq     = king.lsb();
 
+    // король не закрывает от дальнобойных поля за собой
     AttackParams attack_params;
     attack_params.set_blockers(GetOccupied(WHITE, BLACK) ^ king);
 
     while(pieces)
     {
-        Square  from = pieces.poplsb();
-        Piece   type = GetPiece(from);
+        Square from = pieces.poplsb();
         attack_params.set_attacker(from);
-        
-        Bitboard piece_attacks = GetFastAttack(type, attack_params);
-        this->attackers |= piece_attacks;
-
-        if(piece_attacks & king) {
-            this->checkers  |=  from.bitboard();
-            this->defense   &=  GetPiece(from).is(KNIGHT) 
-                                ? from.bitboard() 
-                                : between(ksq, from);
-        }
+        this->attackers |= GetFastAttack(GetPiece(from), attack_params);
     }
 
-    Bitboard pawn_attacks = (opp.is(WHITE)) 
-                            ? step<NORTH_EAST>(pawns) | step<NORTH_WEST>(pawns)
-                            : step<SOUTH_EAST>(pawns) | step<SOUTH_WEST>(pawns);
+    this->attackers |= (opp.is(WHITE)) 
+                       ? step<NORTH_EAST>(pawns) | step<NORTH_WEST>(pawns)
+                       : step<SOUTH_EAST>(pawns) | step<SOUTH_WEST>(pawns);
 
-    this->attackers |= pawn_attacks;
-    
-    if (pawn_attacks & king) 
+    attackersReady = true;
+}
+
+void PositionAttacks::ComputeCheckSquares() const noexcept 
+{
+    const Color opp = side.opp();
+    const Square ksq = GetPieces(opp, KING).lsb();
+
+    // поля, откуда фигура бьет короля, - ее атаки с поля короля (для пешки - пешкой соперника)
+    AttackParams attack_params;
+    attack_params
+        .set_blockers(GetOccupied(WHITE, BLACK))
+        .set_attacker(ksq)
+        .set_color(opp);
+
+    this->checkSquares[PAWN] = GetFastAttack(PAWN, attack_params);
+    this->checkSquares[KNIGHT] = GetFastAttack(KNIGHT, attack_params);
+    this->checkSquares[BISHOP] = GetFastAttack(BISHOP, attack_params);
+    this->checkSquares[ROOK] = GetFastAttack(ROOK, attack_params);
+    this->checkSquares[QUEEN] = checkSquares[BISHOP] | checkSquares[ROOK];
+    this->checkSquares[KING] = Bitboard::Null();
+
+    this->discoverers = SliderBlockers(ksq, side) & GetOccupied(side);
+    checkSquaresReady = true;
+}
+
+bool PositionAttacks::GivesCheck(Move move) const noexcept 
+{
+    if(!checkSquaresReady)
+        ComputeCheckSquares();
+
+    const Square from = move.from();
+    const Square targ = move.targ();
+    const Square ksq = GetPieces(side.opp(), KING).lsb();
+
+    if(checkSquares[GetPiece(from)] & targ.bitboard())
+        return true;
+
+    // вскрытый шах: фигура уходит с линии между своей дальнобойной и королем
+    if((discoverers & from.bitboard()) && !(line_bb(ksq, from) & targ.bitboard()))
+        return true;
+
+    const Bitboard occ = GetOccupied(WHITE, BLACK) ^ from.bitboard();
+    AttackParams attack_params;
+
+    switch (move.flag())
+    {
+    case Q_PROMOTION_MF:
+        return GetFastAttack(QUEEN, attack_params.set_attacker(targ).set_blockers(occ)) & ksq.bitboard();
+    case R_PROMOTION_MF:
+        return GetFastAttack(ROOK, attack_params.set_attacker(targ).set_blockers(occ)) & ksq.bitboard();
+    case B_PROMOTION_MF:
+        return GetFastAttack(BISHOP, attack_params.set_attacker(targ).set_blockers(occ)) & ksq.bitboard();
+    case K_PROMOTION_MF:
+        return GetFastAttack(KNIGHT, attack_params.set_attacker(targ)) & ksq.bitboard();
+    case EN_PASSANT_MF: 
+    {
+        // снятая пешка может открыть линию, которой нет среди discoverers
+        const Bitboard after = (occ ^ where_passant(from, targ).bitboard()) | targ.bitboard();
+        attack_params.set_attacker(ksq).set_blockers(after);
+        return 
+            (GetFastAttack(ROOK, attack_params) & GetPieces(side, ROOK, QUEEN)) |
+            (GetFastAttack(BISHOP, attack_params) & GetPieces(side, BISHOP, QUEEN));
+    }
+    case S_CASTLE_MF:
+    case L_CASTLE_MF:
     {
-        attack_params
-            .set_color(side)
-            .set_attacker(ksq);
-            
-        Bitboard pawn_checkers = GetFastAttack(PAWN, attack_params) & pawns;
-
-        this->checkers  |=  pawn_checkers;
-        this->defense   &=  pawn_checkers;
+        // шах может дать только ладья с нового поля
+        const bool kingSide = move.flag() == S_CASTLE_MF;
+        const Square rookFrom = kingSide ? targ + EAST : targ + 2 * WEST;
+        const Square rookTarg = kingSide ? from + EAST : from + WEST;
+        const Bitboard after = (occ ^ rookFrom.bitboard()) | targ.bitboard() | rookTarg.bitboard();
+        return GetFastAttack(ROOK, attack_params.set_attacker(rookTarg).set_blockers(after)) & ksq.bitboard();
+    }
+    default:
+        return false;
     }
 }
 
@@ -255,6 +389,7 @@ template<StorageType Policy>
 void Position<Policy>::SetFen(std::string_view fen) noexcept 
 {
     State& new_st = st.create();
+    ResetAttackInfo();
 
     std::stringstream ss(fen.data());
 
@@ -282,18 +417,18 @@ void Position<Policy>::SetFen(std::string_view fen) noexcept
 
             switch (symb)
             {
-            case 'K': AddPiece(WHITE, KING,    sqr, new_st.hash);   break;
-            case 'Q': AddPiece(WHITE, QUEEN,   sqr, new_st.hash);   break;
-            case 'P': AddPiece(WHITE, PAWN,    sqr, new_st.hash);   break;
-            case 'N': AddPiece(WHITE, KNIGHT,  sqr, new_st.hash);   break;
-            case 'R': AddPiece(WHITE, ROOK,    sqr, new_st.hash);   break;
-            case 'B': AddPiece(WHITE, BISHOP,  sqr, new_st.hash);   break;
-            case 'k': AddPiece(BLACK, KING,    sqr, new_st.hash);   break;
-            case 'q': AddPiece(BLACK, QUEEN,   sqr, new_st.hash);   break;
-            case 'p': AddPiece(BLACK, PAWN,    sqr, new_st.hash);   break;
-            case 'n': AddPiece(BLACK, KNIGHT,  sqr, new_st.hash);   break;
-            case 'r': AddPiece(BLACK, ROOK,    sqr, new_st.hash);   break;
-            case 'b': AddPiece(BLACK, BISHOP,  sqr, new_st.hash);   break;
+            case 'K': AddPiece(WHITE, KING,    sqr, new_st);   break;
+            case 'Q': AddPiece(WHITE, QUEEN,   sqr, new_st);   break;
+            case 'P': AddPiece(WHITE, PAWN,    sqr, new_st);   break;
+            case 'N': AddPiece(WHITE, KNIGHT,  sqr, new_st);   break;
+            case 'R': AddPiece(WHITE, ROOK,    sqr, new_st);   break;
+            case 'B': AddPiece(WHITE, BISHOP,  sqr, new_st);   break;
+            case 'k': AddPiece(BLACK, KING,    sqr, new_st);   break;
+            case 'q': AddPiece(BLACK, QUEEN,   sqr, new_st);   break;
+            case 'p': AddPiece(BLACK, PAWN,    sqr, new_st);   break;
+            case 'n': AddPiece(BLACK, KNIGHT,  sqr, new_st);   break;
+            case 'r': AddPiece(BLACK, ROOK,    sqr, new_st);   break;
+            case 'b': AddPiece(BLACK, BISHOP,  sqr, new_st);   break;
             default: break;
             }
 
@@ -401,6 +536,10 @@ std::string Position<Policy>::GetFen() const noexcept
 template<StorageType Policy>
 void Position<Policy>::DoMove(Move move) noexcept 
 {
+    st.back().attacks = GetAttackInfo();
+    if constexpr (Policy::CopyMake)
+        SaveBoard();
+
     const Square passant = st.back().passant;
 
     State& new_st   =   st.create();
@@ -420,51 +559,59 @@ void Position<Policy>::DoMove(Move move) noexcept
         else TryToUpdateCastle(side, from);
         break;
     case S_CASTLE_MF:
-        MovePiece(targ + EAST, from + EAST, new_st.hash);
+        MovePiece(targ + EAST, from + EAST, new_st);
         UpdateCastle(side, BOTH_SIDES_CASTLING);
         break;
     case L_CASTLE_MF:
-        MovePiece(targ + 2 * WEST, from + WEST, new_st.hash);
+        MovePiece(targ + 2 * WEST, from + WEST, new_st);
         UpdateCastle(side, BOTH_SIDES_CASTLING);
         break;
     case DOUBLE_MF:
         UpdatePassant(where_passant(from, targ));
         break;
     case EN_PASSANT_MF:
-        RemovePiece(side.opp(), where_passant(from, targ), new_st.hash);
+        RemovePiece(side.opp(), where_passant(from, targ), new_st);
         break;
     case Q_PROMOTION_MF:
-        ReplacePiece(QUEEN, from, new_st.hash);
+        ReplacePiece(QUEEN, from, new_st);
         break;
     case R_PROMOTION_MF:
-        ReplacePiece(ROOK, from, new_st.hash);
+        ReplacePiece(ROOK, from, new_st);
         break;
     case K_PROMOTION_MF:
-        ReplacePiece(KNIGHT, from, new_st.hash);
+        ReplacePiece(KNIGHT, from, new_st);
         break;
     case B_PROMOTION_MF:
-        ReplacePiece(BISHOP, from, new_st.hash);
+        ReplacePiece(BISHOP, from, new_st);
         break;
     }
 
     if(types[targ].isValid()) {
         TryToUpdateCastle(side.opp(), targ); // capture opp rook
         new_st.captured = types[targ];
-        RemovePiece(side.opp(), targ, new_st.hash);
+        RemovePiece(side.opp(), targ, new_st);
         new_st.rule50 = 0;
     } else if(!types[from].is(PAWN)) {
         new_st.rule50++;
     } else new_st.rule50 = 0;
 
-    MovePiece(from, targ, new_st.hash);
+    MovePiece(from, targ, new_st);
 
     side.swap();
     new_st.hash.updateSide();
+    ResetAttackInfo();
 }
 
 template<StorageType Policy>
 void Position<Policy>::UndoMove() noexcept 
 {
+    if constexpr (Policy::CopyMake) {
+        st.rollback();
+        RestoreBoard();
+        SetAttackInfo(st.back().attacks);
+        return;
+    }
+
     const State& old_st = st.back();
     const Move last_move = old_st.move;
     const Piece captured = old_st.captured;
@@ -502,6 +649,41 @@ void Position<Policy>::UndoMove() noexcept
     if(captured.isValid()) {
         AddPiece(side.opp(), captured, targ);
     }
+
+    SetAttackInfo(st.back().attacks);
+}
+
+template<StorageType Policy>
+void Position<Policy>::DoNullMove() noexcept
+{
+    st.back().attacks = GetAttackInfo();
+    if constexpr (Policy::CopyMake)
+        SaveBoard();
+
+    const Square passant = st.back().passant;
+
+    State& new_st = st.create();
+
+    if(passant.isValid()) 
+        new_st.hash.updateEnPassant(passant);
+
+    // позиции до пропуска хода не должны считаться повторением
+    new_st.rule50 = 0;
+
+    side.swap();
+    new_st.hash.updateSide();
+    ResetAttackInfo();
+}
+
+template<StorageType Policy>
+void Position<Policy>::UndoNullMove() noexcept
+{
+    st.rollback();
+    if constexpr (Policy::CopyMake)
+        RestoreBoard();
+    else
+        side.swap();
+    SetAttackInfo(st.back().attacks);
 }
 
 template<StorageType Policy>
@@ -517,10 +699,103 @@ template<StorageType Policy>
 bool Position<Policy>::CanCastle(CastleType ct) const noexcept 
 { 
     const Castle cr = st.back().castle.extract(side, ct);
+    // карта атак соперника - последней, она может быть еще не посчитана
     return 
           cr.has_path()                     &&
-        !(cr.king_path()  & attackers)  &&
-        !(cr.clear_path() & GetOccupied(WHITE, BLACK));
+        !(cr.clear_path() & GetOccupied(WHITE, BLACK)) &&
+        !(cr.king_path()  & GetAttackers());
+}
+
+template<StorageType Policy>
+bool Position<Policy>::IsLegal(Move move) const noexcept 
+{
+    const Square from = move.from();
+    const Square targ = move.targ();
+    const MoveFlag flag = move.flag();
+    const Color us = side;
+    const Color opp = side.opp();
+
+    if(from == targ || !(GetOccupied(us) & from.bitboard()) || GetOccupied(us) & targ.bitboard())
+        return false;
+
+    const Piece piece = types[from];
+    const Bitboard occ = GetOccupied(WHITE, BLACK);
+
+    if(flag == S_CASTLE_MF || flag == L_CASTLE_MF) {
+        const bool kingSide = flag == S_CASTLE_MF;
+        return 
+            piece.is(KING) && !IsCheck() &&
+            targ == from + (kingSide ? 2 * EAST : 2 * WEST) &&
+            CanCastle(kingSide ? KING_SIDE_CASTLING : QUEEN_SIDE_CASTLING);
+    }
+
+    if(piece.is(KING)) {
+        return 
+            flag == DEFAULT_MF &&
+            GetFastAttack(KING, AttackParams{}.set_attacker(from)) & targ.bitboard() &&
+            !(GetAttackers() & targ.bitboard());
+    }
+
+    if(IsDoubleCheck())
+        return false;
+
+    const Bitboard pin_mask = GetPinMask(from);
+    if(pin_mask && IsCheck())
+        return false;
+
+    Bitboard allowed = IsCheck() ? defense : Bitboard::Full();
+    if(pin_mask)
+        allowed &= pin_mask;
+
+    if(!piece.is(PAWN)) {
+        return 
+            flag == DEFAULT_MF &&
+            GetFastAttack(piece, AttackParams{}.set_attacker(from).set_blockers(occ)) & targ.bitboard() & allowed;
+    }
+
+    const int up = us.is(WHITE) ? NORTH : SOUTH;
+    const Bitboard last_rank = us.is(WHITE) ? RankType::Rank8 : RankType::Rank1;
+    const Bitboard start_rank = us.is(WHITE) ? RankType::Rank2 : RankType::Rank7;
+    const bool captures = GetFastAttack(PAWN, AttackParams{}.set_attacker(from).set_color(us)) & targ.bitboard();
+
+    if(flag == EN_PASSANT_MF) 
+    {
+        const Square passant = GetPassant();
+        if(!passant.isValid() || !(targ == passant) || !captures)
+            return false;
+
+        const Square targ_pawn = passant - up;
+        if(IsCheck() && !IsAttacker(targ_pawn))
+            return false;
+
+        return pin_mask ? bool(pin_mask & passant.bitboard()) : CanPassant(from, targ_pawn);
+    }
+
+    if(!(allowed & targ.bitboard()))
+        return false;
+
+    if(flag == DOUBLE_MF) {
+        return 
+            start_rank & from.bitboard() && 
+            targ == from + 2 * up &&
+            !(occ & (from + up).bitboard()) && 
+            !(occ & targ.bitboard());
+    }
+
+    const bool promotion = 
+        flag == Q_PROMOTION_MF || flag == R_PROMOTION_MF || 
+        flag == K_PROMOTION_MF || flag == B_PROMOTION_MF;
+
+    if(flag != DEFAULT_MF && !promotion)
+        return false;
+
+    if(promotion != bool(last_rank & targ.bitboard()))
+        return false;
+
+    if(targ == from + up)
+        return !(occ & targ.bitboard());
+
+    return captures && GetOccupied(opp) & targ.bitboard();
 }
 
 template<StorageType Policy>
@@ -554,6 +829,18 @@ void Position<Policy>::TryToUpdateCastle(Color c, Square maybe_rook) noexcept
     }
 }
 
+template<StorageType Policy>
+void Position<Policy>::SaveBoard() noexcept requires Policy::CopyMake
+{
+    st.board() = static_cast<const Board&>(*this);
+}
+
+template<StorageType Policy>
+void Position<Policy>::RestoreBoard() noexcept requires Policy::CopyMake
+{
+    static_cast<Board&>(*this) = st.board();
+}
+
 template<StorageType Policy>
 bool Position<Policy>::NotEnoughPieces() const noexcept 
 { 
@@ -569,6 +856,7 @@ bool Position<Policy>::NotEnoughPieces() const noexcept
 
 template class Position<StaticStorage>;
 template class Position<DynamicStorage>;
+template class Position<CopyStorage>;
 
 
 } // namespace Core::Logic
\ No newline at end of file
@@ -5,12 +5,11 @@
 #include "zobrist.hpp"
 #include "storage.hpp"
 
-#include <cstring>
 
 namespace Core::Logic
 {
 
-class PositionBase {
+class PositionBase : protected Board {
 public:
 
     static void Setup();
@@ -30,23 +29,16 @@ public:
 protected:
 
     void AddPiece(Color, Piece, Square) noexcept;
-    void AddPiece(Color, Piece, Square, Zobrist&) noexcept;
+    void AddPiece(Color, Piece, Square, State&) noexcept;
 
     [[maybe_unused]] Piece RemovePiece(Color, Square) noexcept;
-    void RemovePiece(Color, Square, Zobrist&) noexcept;
+    void RemovePiece(Color, Square, State&) noexcept;
 
     [[maybe_unused]] Piece MovePiece(Square, Square) noexcept;
-    void MovePiece(Square, Square, Zobrist&) noexcept;
+    void MovePiece(Square, Square, State&) noexcept;
 
     [[maybe_unused]] Piece ReplacePiece(Piece, Square) noexcept;
-    void ReplacePiece(Piece, Square, Zobrist&) noexcept;
-
-protected:
-
-    Bitboard pieces[COLOR_COUNT][PIECE_COUNT];
-    Bitboard occupied[COLOR_COUNT];
-    Piece types[SQUARE_COUNT];
-    Color side;
+    void ReplacePiece(Piece, Square, State&) noexcept;
 
 };
 
@@ -73,34 +65,56 @@ inline constexpr Bitboard PositionBase::GetOccupied(Colors... c) const noexcept
 
 
 
-class PositionAttacks : public PositionBase {
+/*
+Шахи и связки считаются в UpdateAttacks (шах - от последнего хода: прямой и вскрытый),
+атаки соперника - лениво, при первом GetAttackers (ходы короля, рокировка),
+поля шаха - при первом GivesCheck.
+Посчитанное хранится до следующего хода, повторный UpdateAttacks ничего не делает.
+*/
+class PositionAttacks : public PositionBase, protected AttackInfo {
 public:
 
+    using AttackInfo = Logic::AttackInfo;
+
     constexpr bool IsAttacker(Square sqr) const noexcept {return checkers & sqr.bitboard();}
     bool CanPassant(Square from, Square targ) const noexcept;
  
     constexpr bool IsCheck() const noexcept {return checkers;}
     constexpr bool IsDoubleCheck() const noexcept {return checkers.count() == 2;}
 
-    constexpr Bitboard GetAttackers() const noexcept {return attackers;}
+    Bitboard GetAttackers() const noexcept {
+        if(!attackersReady)
+            ComputeAttackers();
+        return attackers;
+    }
     constexpr Bitboard GetDeffensiveSquares() const noexcept {return defense;}
     constexpr Bitboard GetPinnedPieces() const noexcept {return pinned;}
     Bitboard GetPinMask(Square) const noexcept;
     Bitboard GetAttacksTo(Square sqr, Bitboard occ) const noexcept;
+    // фигуры соперника стороны на ходу, бьющие sqr при занятых полях occ
+    Bitboard GetEnemyAttackersTo(Square sqr, Bitboard occ) const noexcept;
 
-    void UpdateAttacks() noexcept;
+    // дает ли шах легальный ход стороны на ходу, без DoMove; требует актуальных UpdateAttacks
+    bool GivesCheck(Move) const noexcept;
 
-private:
-
-    void ComputePins() noexcept;
-    void ComputeAttacks() noexcept;
+    AttackInfo GetAttackInfo() const noexcept {return *this;}
+    void SetAttackInfo(const AttackInfo& info) noexcept {static_cast<AttackInfo&>(*this) = info;}
 
 protected:
 
-    Bitboard attackers;
-    Bitboard pinned;
-    Bitboard checkers;
-    Bitboard defense;
+    // last - ход, которым пришли в позицию; пустой (корень, null move) - шахи ищутся от короля
+    void ComputeAttackInfo(Move last) noexcept;
+    void ResetAttackInfo() noexcept {checksReady = attackersReady = checkSquaresReady = false;}
+
+private:
+
+    // фигуры, единственные между ksq и дальнобойными фигурами цвета by
+    Bitboard SliderBlockers(Square ksq, Color by) const noexcept;
+    void ComputeChecks() noexcept;
+    void ComputeChecks(Move last) noexcept;
+    void ComputeDefense() noexcept;
+    void ComputeAttackers() const noexcept;
+    void ComputeCheckSquares() const noexcept;
 
 };
 
@@ -115,21 +129,40 @@ public:
     Position(const Position<T>&);
 
     void SetFen(std::string_view fen) noexcept;
+    // копия позиции other без ее истории, память под историю не выделяется заново
+    template<StorageType T>
+    void SetPosition(const Position<T>& other) noexcept;
+    // сколько ply поместится в историю, текущая позиция сохраняется
+    void ReserveStack(size_t plies) {st.reserve(plies);}
     std::string GetFen() const noexcept;
     constexpr Square GetPassant() const {return st.back().passant;}
     constexpr const Policy& GetHistory() const noexcept {return st;}
     constexpr Zobrist GetHash() const {return st.back().hash;}
+    constexpr Zobrist GetPawnHash() const {return st.back().pawnHash;}
     constexpr Piece GetCaptured() const {return st.back().captured;}
+    // ход, которым пришли в позицию (пустой у корня и после null move)
+    constexpr Move GetLastMove() const {return st.back().move;}
     constexpr int GetPly() const noexcept {return st.size();}
 
+    // шахи и связки текущей позиции, см. PositionAttacks
+    void UpdateAttacks() noexcept {if(!checksReady) ComputeAttackInfo(st.back().move);}
+
+    // атаки позиции запоминаются в ее State, UndoMove возвращает их без пересчета;
+    // с CopyStorage и доска возвращается копией, сохраненной в DoMove
     void DoMove(Move) noexcept;
     void UndoMove() noexcept;
+    // передача хода без хода (null move pruning)
+    void DoNullMove() noexcept;
+    void UndoNullMove() noexcept;
 
     template<StorageType T> 
     bool IsDraw(const T& globalHistory) const noexcept;
     bool IsDraw() const noexcept;
 
     bool CanCastle(CastleType) const noexcept;
+    // совпадает с тем, что сгенерировал бы MoveList, но без генерации;
+    // как и генерация, требует актуальных UpdateAttacks
+    bool IsLegal(Move) const noexcept;
 
 private:
 
@@ -137,6 +170,8 @@ private:
     void UpdateCastle(Color, CastleType) noexcept;
     void TryToUpdateCastle(Color, Square maybe_rook) noexcept;
     bool NotEnoughPieces() const noexcept;
+    void SaveBoard() noexcept requires Policy::CopyMake;
+    void RestoreBoard() noexcept requires Policy::CopyMake;
 
 private:
 
@@ -149,12 +184,17 @@ template <StorageType Policy>
 template <StorageType T>
 inline Position<Policy>::Position(const Position<T> &pos) 
 {
-    std::memcpy(pieces, pos.pieces, sizeof(Bitboard) * COLOR_COUNT * PIECE_COUNT);
-    std::memcpy(occupied, pos.occupied, sizeof(Bitboard) * COLOR_COUNT);
-    std::memcpy(types, pos.types, sizeof(Piece) * SQUARE_COUNT);
+    SetPosition(pos);
+}
 
-    side = pos.side;
+template <StorageType Policy>
+template <StorageType T>
+inline void Position<Policy>::SetPosition(const Position<T> &pos) noexcept
+{
+    static_cast<Board&>(*this) = static_cast<const Board&>(pos);
+    ResetAttackInfo();
 
+    st.clear();
     st.create() = pos.st.back();
 }
 
@@ -166,7 +206,15 @@ inline bool Position<Policy>::IsDraw(const T &globalHistory) const noexcept {
 }
 
 
+/*
+PositionFM - позиция поиска с историей в заранее выделенной памяти.
+По умолчанию make/unmake (StaticStorage), с POSITION_COPY_MAKE (ATTEMPT_COPY_MAKE в CMake) - copy-make (CopyStorage).
+*/
+#ifdef POSITION_COPY_MAKE
+using PositionFM = Position<CopyStorage>;
+#else
 using PositionFM = Position<StaticStorage>;
+#endif
 using PositionDM = Position<DynamicStorage>;
 
 
@@ -1,5 +1,6 @@
 #include "storage.hpp"
 #include "zobrist.hpp"
+#include <algorithm>
 #include <cassert>
 
 namespace Core::Logic
@@ -8,6 +9,7 @@ namespace Core::Logic
 constexpr void stcopy(State &dst, const State &src)
 {
     dst.hash = src.hash;
+    dst.pawnHash = src.pawnHash;
     dst.castle = src.castle;
     dst.rule50 = src.rule50;
 
@@ -16,63 +18,59 @@ constexpr void stcopy(State &dst, const State &src)
     dst.captured = NO_PIECE;
 }
 
-constexpr bool compareStates(
-    const Zobrist& lkey, const Zobrist& rkey, 
-    int l50, int r50, int d,
-    int& cnt
-) {
-    if(lkey == rkey) {
-        cnt++;
-        if(cnt == MAX_REPETITIONS)
-            return true;
-    }
-
-    else if(!lkey)
-        return true;
-
-    else if(l50 != r50 - d) 
-        return true;
-        
-    return false;
-}
-
-constexpr int countRepetitions(const State* curr, const State* begin, const Zobrist key) 
+int countRepetitions(std::span<const State> history, Zobrist key, int first, int last) noexcept
 {
-    assert(curr && begin);
+    const int size = int(history.size());
+    last = std::min(last, size - 1);
 
-    const int rule50 = curr->rule50;
     int cnt = 0;
-
-    for(const State* hist = curr; hist >= begin; hist--) 
-        if(compareStates(hist->hash, key, curr->rule50, rule50, (curr - hist), cnt))
-            break;
+    for(int d = first; d <= last; d += 2)
+        cnt += history[size - 1 - d].hash == key;
 
     return cnt;
 }
 
-constexpr int countRepetitions(const State* curr, const State* begin)
-{
-    assert(curr && begin);
+#define ASSERT_MSG(expr, msg) \
+    if(!(expr)) { std::cerr << "Assertion failed: " << msg << "\n"; assert(expr); }
 
-    const Zobrist& key = curr->hash;
-    const int rule50 = curr->rule50;
-    int cnt = 1;
+void StaticStorage::reserveImpl(size_t capacity)
+{
+    const size_t size = history ? sizeImpl() : 0;
+    assert(capacity >= 2 && size < capacity);
+    if(history && size_t(last - history.get()) == capacity)
+        return;
 
-    for(const State* hist = curr - 2; hist >= begin; hist--) 
-        if(compareStates(hist->hash, key, curr->rule50, rule50, (curr - hist), cnt))
-            break;
+    std::unique_ptr<State[]> grown(new State[capacity]());
+    if(history)
+        std::copy(history.get(), curr + 1, grown.get());
 
-    return cnt;
+    history = std::move(grown);
+    curr = history.get() + size;
+    last = history.get() + capacity;
 }
 
-#define ASSERT_MSG(expr, msg) \
-    if(!(expr)) { std::cerr << "Assertion failed: " << msg << "\n"; assert(expr); }
+void CopyStorage::reserveImpl(size_t capacity)
+{
+    states.reserveImpl(capacity);
+    if(this->capacity == capacity)
+        return;
+
+    // копии доски нужны только до текущего ply включительно
+    std::unique_ptr<Board[]> grown(new Board[capacity]());
+    if(boards)
+        std::copy(boards.get(), boards.get() + states.sizeImpl() + 1, grown.get());
+
+    boards = std::move(grown);
+    this->capacity = capacity;
+}
 
 State &StaticStorage::createImpl() noexcept
 {
     State* next = curr + 1;
-    assert(next < history + MAX_HISTORY_SIZE);
+    assert(next < last);
 
+    if(curr > history.get())
+        filter.add(curr->hash);
     stcopy(*next, *curr);
     curr = next;
 
@@ -81,33 +79,25 @@ State &StaticStorage::createImpl() noexcept
 
 State &StaticStorage::rollbackImpl() noexcept
 {
-    assert(curr > history);
+    assert(curr > history.get());
     --curr;
+    if(curr > history.get())
+        filter.remove(curr->hash);
     return *curr;
 }
 
 State &StaticStorage::backImpl() noexcept
 {
-    assert(curr > history);
+    assert(curr > history.get());
     return *curr;
 }
 
 const State &StaticStorage::backImpl() const noexcept
 {
-    assert(curr > history);
+    assert(curr > history.get());
     return *curr;
 }
 
-int StaticStorage::countRepetitionsImpl(Zobrist key) const noexcept
-{
-    return countRepetitions(curr, history, key);
-}
-
-int StaticStorage::countRepetitionsImpl() const noexcept
-{
-    return countRepetitions(curr, history);
-}
-
 State &DynamicStorage::createImpl() noexcept 
 {
     State& next = history.emplace_back();
@@ -116,6 +106,7 @@ State &DynamicStorage::createImpl() noexcept
     if(size == 1)
         return next;
 
+    filter.add(history[size - 2].hash);
     stcopy(next, history[size - 2]);
     return next;
 }
@@ -124,6 +115,7 @@ State &DynamicStorage::rollbackImpl() noexcept
 {
     assert(history.size() > 1);
     history.pop_back();
+    filter.remove(history.back().hash);
     return history.back();
 }
 
@@ -151,14 +143,4 @@ const State &DynamicStorage::backImpl() const noexcept
     return history.back();
 }
 
-int DynamicStorage::countRepetitionsImpl(Zobrist key) const noexcept 
-{
-    return countRepetitions(&history.back(), history.data(), key);
-}
-
-int DynamicStorage::countRepetitionsImpl() const noexcept 
-{
-    return countRepetitions(&history.back(), history.data());
-}
-
 } // namespace Core::Logic
\ No newline at end of file
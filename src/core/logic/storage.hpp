@@ -1,26 +1,95 @@
 #pragma once
 
+#include "bitboard.hpp"
 #include "move.hpp"
 #include "zobrist.hpp"
 
+#include <array>
 #include <cassert>
+#include <cstdint>
+#include <memory>
+#include <span>
 #include <vector>
 
 namespace Core::Logic
 {
 
+/*
+Производное от доски. Связки, шахи и поля защиты от шаха считает Position::UpdateAttacks,
+остальное - лениво, при первом запросе: атаки соперника (ходы короля и рокировка)
+и поля шаха королю соперника (Position::GivesCheck).
+Флаги *Ready говорят, что из этого актуально для текущей позиции.
+*/
+struct AttackInfo
+{
+    Bitboard pinned, checkers, defense;
+    mutable Bitboard attackers;
+    // checkSquares[piece] - откуда фигура piece стороны на ходу бьет короля соперника,
+    // discoverers - ее фигуры, единственные между ее дальнобойной фигурой и этим королем
+    mutable Bitboard checkSquares[PIECE_COUNT];
+    mutable Bitboard discoverers;
+
+    bool checksReady{false};
+    mutable bool attackersReady{false};
+    mutable bool checkSquaresReady{false};
+};
+
 struct State
 {
     Zobrist hash{};
+    // ключ только по пешкам (кэш пешечной структуры)
+    Zobrist pawnHash{};
     Castle castle{NO_CASTLING};
     int rule50{0};
 
     Move move{};
     Square passant{NO_SQUARE};
     Piece captured{NO_PIECE};
+
+    // атаки позиции на момент хода из нее, UndoMove возвращает их без пересчета
+    AttackInfo attacks{};
+};
+
+// расстановка фигур: битборды, фигура на каждом поле и сторона на ходу
+struct Board
+{
+    Bitboard pieces[COLOR_COUNT][PIECE_COUNT];
+    Bitboard occupied[COLOR_COUNT];
+    Piece types[SQUARE_COUNT];
+    Color side;
 };
 
 
+/*
+Счетчики ключей позиций истории по младшим битам ключа. Ноль - такой позиции в истории точно нет,
+иначе повторение возможно и проверяется проходом по истории (countRepetitions).
+Хранилище ведет счетчики само: в create добавляется ключ позиции, из которой делается ход,
+в rollback он убирается, так что текущей позиции в фильтре нет.
+*/
+class RepetitionFilter {
+public:
+
+    void add(Zobrist key) noexcept {++counts[index(key)];}
+    void remove(Zobrist key) noexcept {assert(counts[index(key)]); --counts[index(key)];}
+    bool mayContain(Zobrist key) const noexcept {return counts[index(key)];}
+    void clear() noexcept {counts.fill(0);}
+
+private:
+
+    static constexpr size_t Size = 1 << 12;
+    static size_t index(Zobrist key) noexcept {return U64(key) & (Size - 1);}
+
+    std::array<uint16_t, Size> counts{};
+
+};
+
+/*
+Сколько раз key встречается в history через ply: на расстоянии first, first + 2, ... не дальше last
+от последнего состояния. last - обычно rule50, раньше необратимого хода повторений не бывает.
+*/
+int countRepetitions(std::span<const State> history, Zobrist key, int first, int last) noexcept;
+
+
 template<typename Derived>
 class StateStorage {
 public:
@@ -34,12 +103,21 @@ public:
     State& back() noexcept {return cast()->backImpl();}
     const State& back() const noexcept {return cast()->backImpl();}
 
+    // позиция встретилась MAX_REPETITIONS раз (вместе с текущей), 
+    // globalHistory - партия до корня этой истории (ее последнее состояние - наше первое)
     template<typename Parent>
     bool hasRepeated(const StateStorage<Parent>& globalHistory) const noexcept;
-    bool hasRepeated() const noexcept {return cast()->countRepetitionsImpl() == MAX_REPETITIONS;}
+    bool hasRepeated() const noexcept;
 
     size_t size() const noexcept {return cast()->sizeImpl();}
 
+    // хранит ли политика копию доски на каждом ply (copy-make, см. CopyStorage)
+    static constexpr bool CopyMake = false;
+
+    // capacity - сколько состояний поместится без выделения памяти, текущая история сохраняется
+    void reserve(size_t capacity) {cast()->reserveImpl(capacity);}
+    void clear() noexcept {cast()->clearImpl();}
+
 private:
 
     constexpr Derived* cast() noexcept {return static_cast<Derived*>(this);}
@@ -51,50 +129,81 @@ private:
 };
 
 
+template <typename Derived>
+inline bool StateStorage<Derived>::hasRepeated() const noexcept
+{
+    const State& curr = back();
+    if(!cast()->filterImpl().mayContain(curr.hash))
+        return false;
+
+    return 1 + countRepetitions(cast()->statesImpl(), curr.hash, 2, curr.rule50) >= MAX_REPETITIONS;
+}
+
 template <typename Derived>
 template <typename Parent>
 inline bool StateStorage<Derived>::hasRepeated(const StateStorage<Parent> &globalHistory) const noexcept
 {
-    const Derived* der = cast();
+    const State& curr = back();
     const Parent* par = globalHistory.cast();
 
-    if(int cnt = der->countRepetitionsImpl()) 
-    {
-        if(cnt == MAX_REPETITIONS) 
-            return true;
+    if(!cast()->filterImpl().mayContain(curr.hash) && !par->filterImpl().mayContain(curr.hash))
+        return false;
+
+    const std::span<const State> local = cast()->statesImpl();
+    int cnt = 1 + countRepetitions(local, curr.hash, 2, curr.rule50);
+    if(cnt >= MAX_REPETITIONS)
+        return true;
 
-        const int cnt2 = par->countRepetitionsImpl(der->backImpl().hash);
-        return cnt + cnt2 >= MAX_REPETITIONS;
-    }
+    // первое состояние истории совпадает с последним состоянием партии, дальше поиск идет по партии
+    // с той же четностью расстояния до текущей позиции
+    const int root = int(local.size()) - 1;
+    if(curr.rule50 <= root)
+        return false;
 
-    return false;
+    cnt += countRepetitions(par->statesImpl(), curr.hash, root % 2 ? 1 : 2, curr.rule50 - root);
+    return cnt >= MAX_REPETITIONS;
 }
 
 
+/*
+Состояния лежат одним массивом, выделенным заранее (размер задается reserve, по умолчанию DEFAULT_STACK_SIZE),
+ход не выделяет память. Нулевая запись не используется и остается пустой - на ней останавливается поиск повторений.
+*/
 class StaticStorage : public StateStorage<StaticStorage> {
+public:
+
+    StaticStorage() {reserveImpl(DEFAULT_STACK_SIZE);}
+
 protected:
 
+    void reserveImpl(size_t capacity);
+    void clearImpl() noexcept {curr = history.get(); filter.clear();}
+
     State& createImpl() noexcept;
     State& rollbackImpl() noexcept;
 
-    State& frontImpl() noexcept {return *history;}
-    const State& frontImpl() const noexcept {return *history;}
+    State& frontImpl() noexcept {return history[0];}
+    const State& frontImpl() const noexcept {return history[0];}
 
     State& backImpl() noexcept;
     const State& backImpl() const noexcept;
 
-    int countRepetitionsImpl(Zobrist key) const noexcept;
-    int countRepetitionsImpl() const noexcept;
+    // без пустой нулевой записи
+    std::span<const State> statesImpl() const noexcept {return {history.get() + 1, curr + 1};}
+    const RepetitionFilter& filterImpl() const noexcept {return filter;}
 
-    size_t sizeImpl() const noexcept {return curr - history;}
+    size_t sizeImpl() const noexcept {return curr - history.get();}
 
 private:
 
-    State history[MAX_HISTORY_SIZE];
-    State* curr = history;
+    std::unique_ptr<State[]> history;
+    State* curr;
+    State* last;
+    RepetitionFilter filter;
 
     template<typename>
     friend class StateStorage;
+    friend class CopyStorage;
 
 };
 
@@ -102,6 +211,9 @@ private:
 class DynamicStorage : public StateStorage<DynamicStorage> {
 protected:
 
+    void reserveImpl(size_t capacity) {history.reserve(capacity);}
+    void clearImpl() noexcept {history.clear(); filter.clear();}
+
     State& createImpl() noexcept;
     State& rollbackImpl() noexcept;
 
@@ -111,14 +223,15 @@ protected:
     State& backImpl() noexcept;
     const State& backImpl() const noexcept;
 
-    int countRepetitionsImpl(Zobrist key) const noexcept;
-    int countRepetitionsImpl() const noexcept;
+    std::span<const State> statesImpl() const noexcept {return history;}
+    const RepetitionFilter& filterImpl() const noexcept {return filter;}
 
     size_t sizeImpl() const noexcept {return history.size(); }
 
 private:
 
     std::vector<State> history;
+    RepetitionFilter filter;
     template<typename>
     friend class StateStorage;
 
@@ -126,6 +239,51 @@ private:
 };
 
 
+/*
+Copy-make: рядом с каждым состоянием StaticStorage лежит копия доски этого ply.
+Position::DoMove сохраняет ее в текущий ply перед тем, как менять доску,
+UndoMove возвращает копией вместо обратного разбора хода.
+*/
+class CopyStorage : public StateStorage<CopyStorage> {
+public:
+
+    static constexpr bool CopyMake = true;
+
+    CopyStorage() {reserveImpl(DEFAULT_STACK_SIZE);}
+
+    Board& board() noexcept {return boards[states.sizeImpl()];}
+
+protected:
+
+    void reserveImpl(size_t capacity);
+    void clearImpl() noexcept {states.clearImpl();}
+
+    State& createImpl() noexcept {return states.createImpl();}
+    State& rollbackImpl() noexcept {return states.rollbackImpl();}
+
+    State& frontImpl() noexcept {return states.frontImpl();}
+    const State& frontImpl() const noexcept {return states.frontImpl();}
+
+    State& backImpl() noexcept {return states.backImpl();}
+    const State& backImpl() const noexcept {return states.backImpl();}
+
+    std::span<const State> statesImpl() const noexcept {return states.statesImpl();}
+    const RepetitionFilter& filterImpl() const noexcept {return states.filterImpl();}
+
+    size_t sizeImpl() const noexcept {return states.sizeImpl();}
+
+private:
+
+    StaticStorage states;
+    std::unique_ptr<Board[]> boards;
+    size_t capacity = 0;
+
+    template<typename>
+    friend class StateStorage;
+
+};
+
+
 template<typename T>
 concept StorageType = std::derived_from<T, StateStorage<T>>;
 
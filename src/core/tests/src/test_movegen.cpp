@@ -0,0 +1,238 @@
+#include "gtest/gtest.h"
+#include "engine/pick.hpp"
+#include "logic/attack.hpp"
+#include "logic/movelist.hpp"
+#include "logic/position.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using namespace Core::Logic;
+using Core::Engine::MovePicker;
+
+using TPosition = PositionFM;
+
+namespace
+{
+
+const char* Fens[] = {
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "4k3/8/8/2KpP2r/8/8/8/8 w - d6 0 1",
+    "4k3/4r3/8/8/8/8/3PPP2/4K3 w - - 0 1",
+    "5k2/8/8/8/8/8/8/4K2R w K - 0 1",
+};
+
+template<MoveGenType MGT>
+std::vector<uint16_t> Generate(TPosition& pos)
+{
+    MoveList list;
+    list.generate<MGT>(pos);
+    std::vector<uint16_t> moves(list.begin(), list.end());
+    std::sort(moves.begin(), moves.end());
+    return moves;
+}
+
+void CheckNode(TPosition& pos, int depth, bool checkEncodings)
+{
+    pos.UpdateAttacks();
+
+    // шахи от последнего хода совпадают с полным поиском атак на короля
+    const Square ksq = pos.GetPieces(pos.GetSide(), KING).lsb();
+    ASSERT_EQ(
+        pos.GetAttackInfo().checkers, 
+        pos.GetAttacksTo(ksq, pos.GetOccupied(WHITE, BLACK)) & pos.GetOccupied(pos.GetSide().opp())
+    ) << pos.GetFen();
+
+    const std::vector<uint16_t> all = Generate<MoveGenType::All>(pos);
+    const std::vector<uint16_t> forced = Generate<MoveGenType::Forced>(pos);
+    const std::vector<uint16_t> quiet = Generate<MoveGenType::Quiet>(pos);
+
+    std::vector<uint16_t> joined;
+    std::merge(forced.begin(), forced.end(), quiet.begin(), quiet.end(), std::back_inserter(joined));
+    ASSERT_EQ(joined, all) << pos.GetFen();
+
+    ASSERT_EQ(MoveList::count<MoveGenType::All>(pos), all.size()) << pos.GetFen();
+    ASSERT_EQ(MoveList::count<MoveGenType::Forced>(pos), forced.size()) << pos.GetFen();
+    ASSERT_EQ(MoveList::count<MoveGenType::Quiet>(pos), quiet.size()) << pos.GetFen();
+
+    // GivesCheck до хода совпадает с шахом после него, QuietChecks - тихие ходы с шахом
+    std::vector<uint16_t> quietChecks;
+    for(uint16_t move : all) {
+        const bool gives = pos.GivesCheck(move);
+        pos.DoMove(move);
+        pos.UpdateAttacks();
+        const bool check = pos.IsCheck();
+        pos.UndoMove();
+        ASSERT_EQ(gives, check) << pos.GetFen() << " " << Move(move);
+        if(gives && std::binary_search(quiet.begin(), quiet.end(), move))
+            quietChecks.push_back(move);
+    }
+    ASSERT_EQ(Generate<MoveGenType::QuietChecks>(pos), quietChecks) << pos.GetFen();
+
+    if(checkEncodings) {
+        for(Square from = Square::Start(); from <= Square::End(); ++from)
+            for(Square targ = Square::Start(); targ <= Square::End(); ++targ)
+                for(int flag = DEFAULT_MF; flag <= DOUBLE_MF; ++flag) {
+                    const Move move(from, targ, MoveFlag(flag));
+                    const bool generated = std::binary_search(all.begin(), all.end(), uint16_t(move));
+                    ASSERT_EQ(pos.IsLegal(move), generated) << pos.GetFen() << " " << move;
+                }
+    }
+
+    // с ходом из TT и killer-ами из списка тихих ходов каждый ход выдается ровно один раз
+    Move killers[2] = {
+        quiet.empty() ? Move{} : Move(quiet.front()),
+        quiet.empty() ? Move{} : Move(quiet.back())
+    };
+    std::vector<uint16_t> picked;
+    {
+        MovePicker picker(pos, killers, all.empty() ? Move{} : Move(all[all.size() / 2]));
+        while(std::optional move = picker.next()) {
+            picked.push_back(*move);
+            // поиск между ходами не должен портить атаки: UndoMove их возвращает
+            pos.DoMove(*move);
+            pos.UpdateAttacks();
+            pos.UndoMove();
+        }
+    }
+    std::sort(picked.begin(), picked.end());
+    ASSERT_EQ(picked, all) << pos.GetFen();
+
+    if(depth == 0)
+        return;
+
+    for(uint16_t move : all) {
+        pos.DoMove(move);
+        CheckNode(pos, depth - 1, false);
+        pos.UndoMove();
+        if(::testing::Test::HasFatalFailure())
+            return;
+        pos.UpdateAttacks();
+    }
+}
+
+// copy-make идет в ногу с make/unmake, после отмены хода атаки возвращаются из истории без пересчета
+void CheckCopyMake(Position<StaticStorage>& made, Position<CopyStorage>& copied, int depth)
+{
+    made.UpdateAttacks();
+    copied.UpdateAttacks();
+
+    MoveList moves;
+    moves.generate<MoveGenType::All>(made);
+    copied.GetAttackers();
+    const AttackInfo attacks = made.GetAttackInfo();
+
+    auto same = [&]() {
+        ASSERT_EQ(copied.GetFen(), made.GetFen());
+        ASSERT_EQ(copied.GetHash(), made.GetHash());
+        for(const AttackInfo restored : {made.GetAttackInfo(), copied.GetAttackInfo()}) {
+            ASSERT_TRUE(restored.checksReady && restored.attackersReady) << made.GetFen();
+            ASSERT_EQ(restored.attackers, attacks.attackers) << made.GetFen();
+            ASSERT_EQ(restored.pinned, attacks.pinned) << made.GetFen();
+            ASSERT_EQ(restored.checkers, attacks.checkers) << made.GetFen();
+            ASSERT_EQ(restored.defense, attacks.defense) << made.GetFen();
+        }
+    };
+
+    for(Move move : moves) {
+        made.DoMove(move);
+        copied.DoMove(move);
+        ASSERT_EQ(copied.GetFen(), made.GetFen()) << move;
+        ASSERT_EQ(copied.GetHash(), made.GetHash()) << move;
+
+        if(depth > 1)
+            CheckCopyMake(made, copied, depth - 1);
+        else {
+            made.UpdateAttacks();
+            copied.UpdateAttacks();
+        }
+
+        made.UndoMove();
+        copied.UndoMove();
+        same();
+        if(::testing::Test::HasFatalFailure())
+            return;
+    }
+
+    if(!made.IsCheck()) {
+        made.DoNullMove();
+        copied.DoNullMove();
+        made.UpdateAttacks();
+        copied.UpdateAttacks();
+        made.UndoNullMove();
+        copied.UndoNullMove();
+        same();
+    }
+}
+
+}
+
+TEST(MoveGeneration, StagesAndLegality)
+{
+    for(const char* fen : Fens) {
+        TPosition pos(fen);
+        CheckNode(pos, 2, true);
+    }
+}
+
+TEST(MoveGeneration, IsLegalOnChildren)
+{
+    for(const char* fen : Fens) {
+        TPosition pos(fen);
+        pos.UpdateAttacks();
+
+        MoveList moves;
+        moves.generate<MoveGenType::All>(pos);
+        for(Move move : moves) {
+            pos.DoMove(move);
+            CheckNode(pos, 0, true);
+            pos.UndoMove();
+            pos.UpdateAttacks();
+        }
+    }
+}
+
+TEST(MoveGeneration, CopyMakeMatchesMakeUnmake)
+{
+    for(const char* fen : Fens) {
+        Position<StaticStorage> made(fen);
+        Position<CopyStorage> copied(fen);
+        CheckCopyMake(made, copied, 3);
+    }
+}
+
+TEST(MoveGeneration, AttackTablesMatchRayWalk)
+{
+    // таблицы, собранные при компиляции, против обхода лучей на случайных блокерах
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    AttackParams params;
+    const SliderBackend saved = GetSliderBackend();
+
+    for(Square sqr = Square::Start(); sqr < SQUARE_COUNT; ++sqr) {
+        params.set_attacker(sqr).set_blockers(Bitboard::Null());
+
+        for(Piece piece : {KING, KNIGHT})
+            EXPECT_EQ(GetFastAttack(piece, params), GetSlowAttack(piece, params));
+        for(Color clr : {WHITE, BLACK}) {
+            params.set_color(clr);
+            EXPECT_EQ(GetFastAttack(PAWN, params), GetSlowAttack(PAWN, params));
+        }
+
+        for(int i = 0; i < 256; ++i) {
+            seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+            params.set_blockers(Bitboard(seed & (seed >> 11)));
+
+            for(SliderBackend backend : {SliderBackend::Pext, SliderBackend::Magic}) {
+                if(!HasSliderBackend(backend))
+                    continue;
+                SetSliderBackend(backend);
+                for(Piece piece : {BISHOP, ROOK, QUEEN})
+                    EXPECT_EQ(GetFastAttack(piece, params), GetSlowAttack(piece, params));
+            }
+            SetSliderBackend(saved);
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#include "gtest/gtest.h"
+#include "engine/eval.hpp"
+#include "engine/nnue.hpp"
+#include "logic/movelist.hpp"
+#include "logic/position.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+using namespace Core;
+
+namespace
+{
+
+const char* Fens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "4k3/8/8/2KpP2r/8/8/8/8 w - d6 0 1",
+};
+
+// случайные партии: оценка после инкрементальных Update совпадает с оценкой с нуля
+void CheckIncremental(const Engine::NNUE::Network* network)
+{
+    Engine::Evaluation::Setup();
+    std::mt19937 rng(42);
+
+    for(const char* fen : Fens) {
+        for(int game = 0; game < 20; ++game) {
+            Logic::PositionFM pos(fen);
+            Engine::Evaluation eval(network);
+            eval.Init(pos);
+
+            for(int ply = 0; ply < 40; ++ply) {
+                Logic::MoveGenerator<Logic::MoveGenType::All> gen(pos);
+                if(gen.moves.empty())
+                    break;
+
+                const Logic::Move move = gen.moves[rng() % gen.moves.get_size()];
+                pos.DoMove(move);
+                eval.Update(move);
+
+                Engine::Evaluation fresh(network);
+                fresh.Init(pos);
+                ASSERT_EQ(eval.Score(), fresh.Score()) << pos.GetFen() << " " << move;
+            }
+        }
+    }
+}
+
+}
+
+TEST(NNUE, IncrementalMatchesRefresh)
+{
+    Engine::NNUE::Network network;
+    network.Randomize(1);
+    CheckIncremental(&network);
+}
+
+TEST(NNUE, PestoIncrementalMatchesInit)
+{
+    CheckIncremental(nullptr);
+}
+
+TEST(NNUE, SaveLoad)
+{
+    const std::string path = (std::filesystem::temp_directory_path() / "attempt101_nnue_test.bin").string();
+
+    Engine::NNUE::Network network;
+    network.Randomize(2);
+    ASSERT_TRUE(network.Save(path));
+
+    Engine::NNUE::Network loaded;
+    ASSERT_TRUE(loaded.Load(path));
+
+    for(const char* fen : Fens) {
+        Logic::PositionFM pos(fen);
+        Engine::NNUE::Accumulator a, b;
+        network.Refresh(a, pos);
+        loaded.Refresh(b, pos);
+        EXPECT_EQ(network.Evaluate(a, pos.GetSide()), loaded.Evaluate(b, pos.GetSide()));
+    }
+
+    // обрезанный файл не загружается, загруженная сеть остается прежней
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    EXPECT_FALSE(loaded.Load(path));
+
+    std::filesystem::remove(path);
+}
@@ -14,7 +14,8 @@ TEST(TestRepetition, Basic)
         posHistory.DoMove({c8, d8,DEFAULT_MF});
         posHistory.DoMove({a1, g1,DEFAULT_MF});
         posHistory.DoMove({d8, c8,DEFAULT_MF});
-        if(i < 2) {
+        // начальная позиция встретилась i + 2 раза
+        if(i < 1) {
             EXPECT_FALSE(posHistory.IsDraw());
         } else {
             EXPECT_TRUE(posHistory.IsDraw());
@@ -26,13 +27,11 @@ TEST(TestRepetition, History)
 {
     Position<DynamicStorage> posHistory("2k5/8/8/8/8/8/8/6QK w - - 0 1");
 
-    for(int i = 0; i < 2; ++i) {
-        posHistory.DoMove({g1, a1,DEFAULT_MF});
-        posHistory.DoMove({c8, d8,DEFAULT_MF});
-        posHistory.DoMove({a1, g1,DEFAULT_MF});
-        posHistory.DoMove({d8, c8,DEFAULT_MF});
-        EXPECT_FALSE(posHistory.IsDraw());
-    }
+    posHistory.DoMove({g1, a1,DEFAULT_MF});
+    posHistory.DoMove({c8, d8,DEFAULT_MF});
+    posHistory.DoMove({a1, g1,DEFAULT_MF});
+    posHistory.DoMove({d8, c8,DEFAULT_MF});
+    EXPECT_FALSE(posHistory.IsDraw());
 
     Position<StaticStorage> pos(posHistory);
     pos.DoMove({g1, a1,DEFAULT_MF});
@@ -40,5 +39,30 @@ TEST(TestRepetition, History)
     pos.DoMove({a1, g1,DEFAULT_MF});
     pos.DoMove({d8, c8,DEFAULT_MF});
 
+    // в истории поиска позиция встретилась дважды, третий раз - в партии
+    EXPECT_FALSE(pos.IsDraw());
     EXPECT_TRUE(pos.IsDraw(posHistory.GetHistory()));
-}
\ No newline at end of file
+
+    pos.UndoMove();
+    EXPECT_FALSE(pos.IsDraw(posHistory.GetHistory()));
+}
+
+// корень поиска на нечетном расстоянии от текущей позиции: в партии сравниваются позиции той же стороны
+TEST(TestRepetition, HistoryOddRoot)
+{
+    Position<DynamicStorage> posHistory("2k5/8/8/8/8/8/8/6QK w - - 0 1");
+
+    posHistory.DoMove({g1, a1,DEFAULT_MF});
+    posHistory.DoMove({c8, d8,DEFAULT_MF});
+    posHistory.DoMove({a1, g1,DEFAULT_MF});
+    posHistory.DoMove({d8, c8,DEFAULT_MF});
+    posHistory.DoMove({g1, a1,DEFAULT_MF});
+
+    Position<StaticStorage> pos(posHistory);
+    pos.DoMove({c8, d8,DEFAULT_MF});
+    pos.DoMove({a1, g1,DEFAULT_MF});
+    pos.DoMove({d8, c8,DEFAULT_MF});
+
+    EXPECT_FALSE(pos.IsDraw());
+    EXPECT_TRUE(pos.IsDraw(posHistory.GetHistory()));
+}
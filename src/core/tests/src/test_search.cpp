@@ -0,0 +1,141 @@
+#include "gtest/gtest.h"
+#include "engine/eval.hpp"
+#include "engine/search.hpp"
+#include "logic/movelist.hpp"
+#include "logic/position.hpp"
+
+#include <future>
+#include <random>
+
+using namespace Core;
+
+namespace
+{
+
+Engine::Search::Info Think(const Logic::PositionDM& pos, int maxDepth, int stackSize)
+{
+    std::promise<Engine::Search::Info> done;
+    std::future<Engine::Search::Info> result = done.get_future();
+
+    Engine::Search::Options options;
+    options.timeSec = 60;
+    options.ttSizeMB = 16;
+    options.maxDepth = maxDepth;
+    options.stackSize = stackSize;
+    options.onMove = [&done](Engine::Search::Info info) {done.set_value(info);};
+
+    Engine::Search search;
+    search.Init(options);
+    search.SetPosition(pos);
+    search.Launch();
+    search.Think();
+
+    return result.get();
+}
+
+Engine::Search::Info Think(const char* fen, int maxDepth, int stackSize)
+{
+    Logic::PositionDM pos(fen);
+    return Think(pos, maxDepth, stackSize);
+}
+
+}
+
+// стек позиции и оценки выдерживает линии длиннее старого предела в 50 ply
+TEST(SearchStack, LongLineRollsBack)
+{
+    constexpr int Plies = 300;
+
+    Engine::Evaluation::Setup();
+    std::mt19937 rng(7);
+
+    Logic::PositionFM pos("4k3/8/8/8/8/8/8/4K3 w - - 0 1");
+    pos.ReserveStack(Plies + 2);
+    Engine::Evaluation eval(nullptr, true, Plies + 2);
+    eval.Init(pos);
+
+    const Logic::Zobrist hash = pos.GetHash();
+    const int score = eval.Score();
+    const int rootPly = pos.GetPly();
+
+    for(int ply = 0; ply < Plies; ++ply) {
+        Logic::MoveGenerator<Logic::MoveGenType::All> gen(pos);
+        ASSERT_FALSE(gen.moves.empty());
+
+        const Logic::Move move = gen.moves[rng() % gen.moves.get_size()];
+        pos.DoMove(move);
+        eval.Update(move);
+    }
+
+    EXPECT_EQ(pos.GetPly(), rootPly + Plies);
+
+    for(int ply = 0; ply < Plies; ++ply) {
+        pos.UndoMove();
+        eval.Rollback();
+    }
+
+    EXPECT_EQ(pos.GetHash(), hash);
+    EXPECT_EQ(eval.Score(), score);
+}
+
+// пешечный эндшпиль: итерации доходят до глубины далеко за прежним потолком в 49
+TEST(SearchStack, DeepEndgameNotTruncated)
+{
+    const Engine::Search::Info info = Think("k7/8/1P6/1K6/8/8/8/8 w - - 0 1", 100, 256);
+    EXPECT_EQ(info.depth, 100);
+    EXPECT_FALSE(info.bestMove == Logic::Move{});
+}
+
+// глубина ограничивается размером стека
+TEST(SearchStack, DepthClampedToStack)
+{
+    const Engine::Search::Info info = Think("k7/8/1P6/1K6/8/8/8/8 w - - 0 1", 100, 64);
+    EXPECT_EQ(info.depth, 62);
+}
+
+// на полном стеке глубина ограничивается глубиной, которую хранит таблица транспозиций
+TEST(SearchStack, DepthClampedToTT)
+{
+    const Engine::Search::Info info = Think("k7/8/1P6/1K6/8/8/8/8 w - - 0 1", Logic::MAX_PLY, Logic::MAX_PLY);
+    EXPECT_EQ(info.depth, Engine::MaxTTDepth);
+    EXPECT_FALSE(info.bestMove == Logic::Move{});
+}
+
+// без ходов в корне поиск все равно отдает результат: пустой ход, мат или ничья
+TEST(SearchRoot, MateAndStalemate)
+{
+    const Engine::Search::Info mate = Think("7k/6Q1/6K1/8/8/8/8/8 b - - 0 1", 3, 64);
+    EXPECT_TRUE(mate.bestMove == Logic::Move{});
+    EXPECT_EQ(mate.eval, -Logic::INF);
+
+    const Engine::Search::Info stalemate = Think("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1", 3, 64);
+    EXPECT_TRUE(stalemate.bestMove == Logic::Move{});
+    EXPECT_EQ(stalemate.eval, Logic::DRAW_SCORE);
+}
+
+// ход, повторяющий позицию в третий раз, - ничья только для этого хода: 
+// узел все равно выбирает выигрыш ладьи Bxa4 (конь на f2 защищен пешкой)
+TEST(SearchRepetition, DrawnChildDoesNotHideWin)
+{
+    using namespace Logic;
+
+    PositionDM game("7k/3b4/8/8/R7/4p3/6PP/3n2K1 w - - 0 1");
+    for(int cycle = 0; cycle < 2; ++cycle) {
+        game.DoMove({g1, h1, DEFAULT_MF});
+        game.DoMove({d1, f2, DEFAULT_MF});
+        if(cycle == 0) {
+            game.DoMove({h1, g1, DEFAULT_MF});
+            game.DoMove({f2, d1, DEFAULT_MF});
+        }
+    }
+
+    // единственный ход Kg1, после него у черных Nd1 - третье повторение
+    const Engine::Search::Info forced = Think(game, 6, 64);
+    EXPECT_TRUE(forced.bestMove == Move(h1, g1, DEFAULT_MF));
+    EXPECT_LT(forced.eval, -300);
+
+    game.DoMove({h1, g1, DEFAULT_MF});
+    const Engine::Search::Info root = Think(game, 6, 64);
+    EXPECT_TRUE(root.bestMove == Move(d7, a4, DEFAULT_MF));
+    EXPECT_GT(root.eval, 300);
+}
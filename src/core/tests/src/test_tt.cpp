@@ -1,5 +1,12 @@
 #include "gtest/gtest.h"
+#include <atomic>
 #include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <vector>
+#include "engine/evalcache.hpp"
 #include "engine/tt.hpp"
 
 using namespace Core::Engine;
@@ -52,4 +59,175 @@ TEST(TestTransposition, Last) {
     tt.store(k, 30, {}, 3, EntryType::Exact);
     EXPECT_EQ(tt.probe(k, 2, -9999, 9999).score.value(), 30);
 
+}
+
+TEST(TestTransposition, StaticEval) {
+    Transposition tt; tt.resize(1);
+    uint64_t k = 0x0123456789ABCDEFULL;
+
+    tt.store(k, 100, {}, 5, EntryType::Exact);
+    EXPECT_FALSE(tt.probe(k, 5, -9999, 9999).eval.has_value());
+
+    tt.store(k, 100, {}, 5, EntryType::Exact, -321);
+    auto r = tt.probe(k, 5, -9999, 9999);
+    EXPECT_EQ(r.score.value(), 100);
+    EXPECT_EQ(r.eval.value(), -321);
+
+    // оценка не зависит от глубины записи и переживает перезапись без нее
+    EXPECT_EQ(tt.probe(k, 9, -9999, 9999).eval.value(), -321);
+    tt.store(k, 40, {}, 7, EntryType::Exact);
+    r = tt.probe(k, 7, -9999, 9999);
+    EXPECT_EQ(r.score.value(), 40);
+    EXPECT_EQ(r.eval.value(), -321);
+}
+
+TEST(TestEvalCache, StoreProbe) {
+    EvalCache cache;
+    uint64_t k = 0xDEADBEEF12345678ULL;
+
+    EXPECT_FALSE(cache.Probe(k).has_value());
+    cache.Store(k, -1234);
+    EXPECT_EQ(cache.Probe(k).value(), -1234);
+
+    // тот же индекс, другой ключ
+    EXPECT_FALSE(cache.Probe(k ^ (1ULL << 40)).has_value());
+    cache.Store(k ^ (1ULL << 40), 77);
+    EXPECT_EQ(cache.Probe(k ^ (1ULL << 40)).value(), 77);
+    EXPECT_FALSE(cache.Probe(k).has_value());
+}
+
+TEST(TestTransposition, Concurrent) {
+    Transposition tt; tt.resize(1);
+
+    // содержимое записи однозначно выводится из ключа,
+    // поэтому любое несоответствие при попадании - порванная запись
+    auto score = [](uint64_t k) {return int16_t(k >> 48);};
+    auto move = [](uint64_t k) {return Core::Logic::Move(uint16_t(k >> 32));};
+
+    constexpr int Threads = 8;
+    constexpr int Iterations = 200000;
+
+    std::atomic<long long> hits = 0, corrupted = 0;
+    std::vector<std::thread> threads;
+
+    for(int t = 0; t < Threads; ++t) {
+        threads.emplace_back([&, t]() {
+            std::mt19937_64 gen(t);
+            for(int i = 0; i < Iterations; ++i) {
+                const uint64_t k = gen() % 100000 * 0x9E3779B97F4A7C15ULL;
+                if(i % 2) {
+                    tt.store(k, score(k), move(k), uint8_t(k), EntryType::Exact);
+                    continue;
+                }
+                auto r = tt.probe(k, 0, -30000, 30000);
+                if(!r.score) 
+                    continue;
+                hits++;
+                if(*r.score != score(k) || *r.move != move(k))
+                    corrupted++;
+            }
+        });
+    }
+
+    for(auto& thread : threads)
+        thread.join();
+
+    EXPECT_GT(hits, 0);
+    EXPECT_EQ(corrupted, 0) << "hits: " << hits;
+}
+
+TEST(TestTransposition, Aging) {
+    Transposition tt; tt.resize(1);
+
+    // соседние ключи с одинаковыми старшими битами попадают в один кластер
+    const uint64_t base = 0xDEADBEEF00000000ULL;
+
+    for(uint64_t i = 0; i < 3; ++i)
+        tt.store(base + i, 1, {}, 20, EntryType::Exact);
+
+    for(int i = 0; i < 3; ++i)
+        tt.new_search();
+
+    tt.store(base + 3, 2, {}, 10, EntryType::Exact);
+    tt.store(base + 4, 3, {}, 1, EntryType::Exact);
+
+    // вытесняется глубокая, но старая запись, а не свежая
+    EXPECT_TRUE(tt.probe(base + 3, 0, -9999, 9999).score.has_value());
+    EXPECT_TRUE(tt.probe(base + 4, 0, -9999, 9999).score.has_value());
+
+    int old = 0;
+    for(uint64_t i = 0; i < 3; ++i)
+        old += tt.probe(base + i, 0, -9999, 9999).score.has_value();
+    EXPECT_EQ(old, 2);
+}
+
+TEST(TestTransposition, Hashfull) {
+    Transposition tt; tt.resize(1);
+    EXPECT_EQ(tt.hashfull(), 0);
+
+    for(uint64_t i = 0; i < 200000; ++i)
+        tt.store(i * 0x9E3779B97F4A7C15ULL, 1, {}, 1, EntryType::Exact);
+    EXPECT_GT(tt.hashfull(), 900);
+
+    tt.new_search();
+    EXPECT_EQ(tt.hashfull(), 0);
+}
+
+TEST(TestTransposition, SaveLoad) {
+    const std::string path = (std::filesystem::temp_directory_path() / "attempt101_tt_test.bin").string();
+
+    Transposition tt;
+    tt.resize(1);
+    tt.new_search();
+
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> keys(1000);
+    for(uint64_t& key : keys) {
+        key = rng();
+        tt.store(key, int16_t(key % 1000), {}, 6, EntryType::Exact);
+    }
+    const int hashfull = tt.hashfull();
+
+    ASSERT_TRUE(tt.save(path));
+
+    Transposition loaded;
+    loaded.resize(4);
+    ASSERT_TRUE(loaded.load(path));
+    EXPECT_EQ(loaded.hashfull(), hashfull);
+
+    for(uint64_t key : keys) {
+        auto a = tt.probe(key, 6, -30000, 30000);
+        auto b = loaded.probe(key, 6, -30000, 30000);
+        EXPECT_EQ(a.score, b.score);
+    }
+
+    // загруженную таблицу можно использовать как обычную
+    loaded.store(keys[0], 77, {}, 20, EntryType::Exact);
+    EXPECT_EQ(loaded.probe(keys[0], 20, -30000, 30000).score, 77);
+
+    auto flip = [&path](std::streamoff offset) {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(offset);
+        const char byte = char(file.get() ^ 1);
+        file.seekp(offset);
+        file.put(byte);
+    };
+
+    // испорченные данные находит только проверка контрольной суммы, 
+    // при отказе таблица остается прежней
+    flip(4096 + 100);
+    EXPECT_FALSE(loaded.load(path, true));
+    EXPECT_EQ(loaded.probe(keys[0], 20, -30000, 30000).score, 77);
+
+    Transposition unchecked;
+    EXPECT_TRUE(unchecked.load(path));
+
+    // испорченный заголовок не принимается и без нее
+    flip(8);
+    EXPECT_FALSE(loaded.load(path));
+    EXPECT_EQ(loaded.probe(keys[0], 20, -30000, 30000).score, 77);
+
+    EXPECT_FALSE(loaded.load(path + ".missing"));
+
+    std::filesystem::remove(path);
 }
\ No newline at end of file
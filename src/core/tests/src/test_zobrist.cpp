@@ -15,17 +15,20 @@ TEST_P(ZobristHashingTest, WithParams)
     Position<StaticStorage> pos(fen);
 
    Zobrist hash = pos.GetHash();
+   Zobrist pawnHash = pos.GetPawnHash();
 
     if(move) 
         pos.DoMove(*move);
 
     Position<StaticStorage> pos2(pos.GetFen());
     EXPECT_EQ(pos.GetHash(), pos2.GetHash());
+    EXPECT_EQ(pos.GetPawnHash(), pos2.GetPawnHash());
 
     if(move) 
         pos.UndoMove();
 
     EXPECT_EQ(pos.GetHash(), hash);
+    EXPECT_EQ(pos.GetPawnHash(), pawnHash);
 }
 
 INSTANTIATE_TEST_SUITE_P(
@@ -63,6 +66,7 @@ void check_hash_stability(Position<StaticStorage> &pos, int depth)
         {
             Position<DynamicStorage> copy(pos.GetFen());
             ASSERT_EQ(pos.GetHash(), copy.GetHash()) << pos.GetFen();
+            ASSERT_EQ(pos.GetPawnHash(), copy.GetPawnHash()) << pos.GetFen();
         }
 
         check_hash_stability(pos, depth - 1);
@@ -75,4 +79,25 @@ TEST(ZobristHashingTest, OnDepth) {
     Position<StaticStorage> pos("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -");
     pos.UpdateAttacks();
     check_hash_stability(pos, 4);
-}
\ No newline at end of file
+}
+
+TEST(ZobristHashingTest, NullMove) {
+    for(const char* fen : {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "6k1/8/8/8/4Pp2/8/8/6K1 b - e3 0 1"
+    }) {
+        Position<StaticStorage> pos(fen);
+        const Zobrist hash = pos.GetHash();
+
+        pos.DoNullMove();
+        EXPECT_NE(pos.GetSide(), Position<StaticStorage>(fen).GetSide());
+        EXPECT_FALSE(pos.GetPassant().isValid());
+
+        Position<StaticStorage> copy(pos.GetFen());
+        EXPECT_EQ(pos.GetHash(), copy.GetHash()) << pos.GetFen();
+
+        pos.UndoNullMove();
+        EXPECT_EQ(pos.GetHash(), hash);
+        EXPECT_EQ(pos.GetFen(), Position<StaticStorage>(fen).GetFen());
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <iosfwd>
+
+/*
+Поиск по фиксированному набору позиций до фиксированной глубины.
+Для каждой позиции создается новый Search (пустые таблицы и history),
+поэтому в 1 поток число узлов от запуска к запуску одно и то же
+и служит сигнатурой: любое изменение поиска или оценки его меняет.
+В несколько потоков узлы зависят от планировщика, сигнатура не печатается.
+args: [depth = 9] [threads = 1] [hash MB = 16]
+*/
+void Bench(std::istream& args, std::ostream& out);
@@ -0,0 +1,26 @@
+#include "bench.hpp"
+#include "uci.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <string_view>
+
+/*
+uci                             - протокол UCI через stdin/stdout
+uci bench [depth] [threads] [hash MB] - замер скорости, см. bench.hpp
+*/
+int main(int argc, char* argv[])
+{
+    std::ios::sync_with_stdio(false);
+
+    if(argc > 1 && std::string_view(argv[1]) == "bench") {
+        std::stringstream args;
+        for(int i = 2; i < argc; ++i)
+            args << argv[i] << ' ';
+        Bench(args, std::cout);
+        return 0;
+    }
+
+    Uci uci(std::cout);
+    uci.run(std::cin);
+}
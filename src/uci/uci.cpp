@@ -0,0 +1,348 @@
+#include "uci.hpp"
+#include "bench.hpp"
+
+#include "logic/movelist.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+
+using namespace Core;
+
+namespace 
+{
+
+constexpr std::string_view StartFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+constexpr auto Infinite = std::chrono::milliseconds::max();
+
+// при sudden death считаем, что до конца партии осталось столько ходов
+constexpr int MovesToGo = 30;
+
+std::string ScoreToString(int score)
+{
+    if(std::abs(score) >= Logic::INF - Logic::MAX_PLY) {
+        const int moves = (Logic::INF - std::abs(score) + 1) / 2;
+        return std::format("mate {}", score > 0 ? moves : -moves);
+    }
+    return std::format("cp {}", score);
+}
+
+}
+
+Uci::Uci(std::ostream& out) : out(out), pos(StartFen)
+{
+    options.timeSec = 0;
+    options.ttSizeMB = 64;
+    options.maxDepth = Logic::MAX_PLY;
+    options.threads = 1;
+
+    search.SetPosition(pos);
+}
+
+Uci::~Uci()
+{
+    search.Halt();
+    search.Stop();
+}
+
+void Uci::run(std::istream& in)
+{
+    // cin привязан к cout и сбрасывал бы его при каждом чтении без outMtx,
+    // параллельно с send из потока поиска; send и так сбрасывает каждую строку
+    in.tie(nullptr);
+
+    std::string line;
+    while(std::getline(in, line))
+    {
+        std::istringstream is(line);
+        std::string cmd;
+        is >> cmd;
+
+        if(cmd == "uci")                uci();
+        else if(cmd == "isready")       isready();
+        else if(cmd == "setoption")     setoption(is);
+        else if(cmd == "ucinewgame")    newgame();
+        else if(cmd == "position")      position(is);
+        else if(cmd == "go")            go(is);
+        else if(cmd == "stop")          stop();
+        else if(cmd == "ponderhit")     ponderhit();
+        else if(cmd == "bench")         {wait(); Bench(is, out);}
+        else if(cmd == "quit")          break;
+        else if(!cmd.empty())           send("info string unknown command " + cmd);
+    }
+
+    wait();
+}
+
+void Uci::uci()
+{
+    send("id name Attempt101");
+    send("id author w1zZzyh");
+    send(std::format("option name Hash type spin default {} min 1 max 65536", options.ttSizeMB));
+    send(std::format("option name Threads type spin default {} min 1 max 256", options.threads));
+    send(std::format("option name Move Overhead type spin default {} min 0 max 5000", moveOverheadMs));
+    send("option name EvalFile type string default <empty>");
+    send("option name Ponder type check default false");
+    send("uciok");
+}
+
+void Uci::isready()
+{
+    // тяжелую инициализацию (таблица, сеть) делаем здесь, если не мешаем поиску
+    bool idle;
+    {
+        std::lock_guard lock(mtx);
+        idle = !searching;
+    }
+    if(idle)
+        init();
+
+    send("readyok");
+}
+
+void Uci::setoption(std::istringstream& is)
+{
+    // setoption name <имя из нескольких слов> value <значение>
+    std::string token, name, value;
+    is >> token;
+
+    while(is >> token && token != "value")
+        name += (name.empty() ? "" : " ") + token;
+    std::getline(is >> std::ws, value);
+
+    try {
+        if(name == "Hash")
+            options.ttSizeMB = std::max(1, std::stoi(value));
+        else if(name == "Threads")
+            options.threads = std::clamp(std::stoi(value), 1, 256);
+        else if(name == "EvalFile")
+            options.nnueFile = value == "<empty>" ? "" : value;
+        else if(name == "Move Overhead") {
+            moveOverheadMs = std::max(0, std::stoi(value));
+            return;
+        }
+        else if(name == "Ponder")
+            return;
+        else {
+            send("info string unknown option " + name);
+            return;
+        }
+    } catch(const std::exception&) {
+        send(std::format("info string bad value for {}: {}", name, value));
+        return;
+    }
+
+    dirty = true;
+}
+
+void Uci::init()
+{
+    if(!dirty)
+        return;
+
+    // Init забирает callback-и из options
+    options.onMove = [this](Engine::Search::Info info) {on_move(info);};
+    options.onIteration = [this](Engine::Search::Info info) {on_iteration(info);};
+
+    search.Init(options);
+    if(!launched) {
+        search.Launch();
+        launched = true;
+    }
+
+    dirty = false;
+}
+
+void Uci::newgame()
+{
+    wait();
+    init();
+    search.NewGame();
+}
+
+void Uci::position(std::istringstream& is)
+{
+    wait();
+
+    std::string token, fen;
+    is >> token;
+
+    if(token == "startpos") {
+        fen = StartFen;
+        is >> token;
+    } else if(token == "fen") {
+        while(is >> token && token != "moves")
+            fen += token + ' ';
+    } else {
+        return;
+    }
+
+    pos = Logic::PositionDM(fen);
+
+    // после "moves"
+    while(is >> token) {
+        std::optional move = parse_move(token);
+        if(!move) {
+            send("info string illegal move " + token);
+            break;
+        }
+        pos.DoMove(*move);
+    }
+}
+
+std::optional<Logic::Move> Uci::parse_move(const std::string& str)
+{
+    Logic::MoveGenerator<Logic::MoveGenType::All> gen(pos);
+    for(Logic::Move move : gen.moves)
+        if(move.to_string() == str)
+            return move;
+    return std::nullopt;
+}
+
+void Uci::go(std::istringstream& is)
+{
+    wait();
+    init();
+
+    long long time[Logic::COLOR_COUNT] = {-1, -1};
+    long long inc[Logic::COLOR_COUNT] = {0, 0};
+    long long movetime = -1;
+    int movestogo = 0;
+    int depth = Logic::MAX_PLY;
+    bool infinite = false;
+    bool ponder = false;
+
+    std::string token;
+    while(is >> token)
+    {
+        if(token == "wtime")            is >> time[Logic::WHITE];
+        else if(token == "btime")       is >> time[Logic::BLACK];
+        else if(token == "winc")        is >> inc[Logic::WHITE];
+        else if(token == "binc")        is >> inc[Logic::BLACK];
+        else if(token == "movestogo")   is >> movestogo;
+        else if(token == "movetime")    is >> movetime;
+        else if(token == "depth")       is >> depth;
+        else if(token == "infinite")    infinite = true;
+        else if(token == "ponder")      ponder = true;
+    }
+
+    const Logic::Color side = pos.GetSide();
+    std::chrono::milliseconds budget = Infinite;
+
+    if(movetime >= 0) {
+        budget = std::chrono::milliseconds(std::max(1LL, movetime - moveOverheadMs));
+    } else if(time[side] >= 0) {
+        const long long left = std::max(1LL, time[side] - moveOverheadMs);
+        const long long share = left / (movestogo ? movestogo + 1 : MovesToGo) + inc[side] * 3 / 4;
+        budget = std::chrono::milliseconds(std::clamp(share, 1LL, left));
+    }
+
+    {
+        std::lock_guard lock(mtx);
+        searching = true;
+        holding = infinite || ponder;
+        pending.reset();
+        ponderBudget = budget;
+        goStart = std::chrono::steady_clock::now();
+    }
+
+    search.SetLimits(infinite || ponder ? Infinite : budget, depth);
+    search.Think();
+}
+
+void Uci::ponderhit()
+{
+    std::unique_lock lock(mtx);
+    if(!searching && !pending)
+        return;
+
+    holding = false;
+
+    // поиск уже закончился, пока соперник думал
+    if(pending) {
+        const Engine::Search::Info info = *pending;
+        pending.reset();
+        lock.unlock();
+        send_best(info);
+        return;
+    }
+
+    const auto passed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - goStart
+    );
+    search.SetTimeLimit(ponderBudget == Infinite ? Infinite : passed + ponderBudget);
+}
+
+void Uci::stop()
+{
+    std::unique_lock lock(mtx);
+    holding = false;
+
+    if(pending) {
+        const Engine::Search::Info info = *pending;
+        pending.reset();
+        lock.unlock();
+        send_best(info);
+        return;
+    }
+
+    lock.unlock();
+    search.Halt();
+}
+
+void Uci::wait()
+{
+    stop();
+
+    std::unique_lock lock(mtx);
+    cv.wait(lock, [this]() {return !searching;});
+}
+
+void Uci::on_iteration(const Engine::Search::Info& info)
+{
+    const long long ms = info.time.count();
+    send(std::format(
+        "info depth {} score {} nodes {} nps {} hashfull {} time {} pv {}",
+        info.depth, ScoreToString(info.eval), info.nodes, info.nodes * 1000 / std::max(1LL, ms),
+        info.hashfull, ms, info.bestMove.to_string()
+    ));
+}
+
+void Uci::on_move(const Engine::Search::Info& info)
+{
+    std::unique_lock lock(mtx);
+
+    if(holding) {
+        pending = info;
+    } else {
+        // send_best читает pos, поэтому searching снимаем только после него
+        lock.unlock();
+        send_best(info);
+        lock.lock();
+    }
+
+    searching = false;
+    cv.notify_all();
+}
+
+void Uci::send_best(const Engine::Search::Info& info)
+{
+    Logic::Move best = info.bestMove;
+
+    // поиск прервали до конца первой итерации
+    if(!best) {
+        Logic::MoveGenerator<Logic::MoveGenType::All> gen(pos);
+        if(!gen.moves.empty())
+            best = gen.moves[0];
+    }
+
+    send(best ? "bestmove " + best.to_string() : "bestmove 0000");
+}
+
+void Uci::send(const std::string& line)
+{
+    std::lock_guard lock(outMtx);
+    out << line << std::endl;
+}
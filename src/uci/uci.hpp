@@ -0,0 +1,78 @@
+#pragma once
+
+#include "engine/search.hpp"
+#include "logic/move.hpp"
+#include "logic/position.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <iosfwd>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+
+/*
+Протокол UCI поверх Core::Engine::Search.
+Команды читаются в потоке run, поиск идет в потоке Search:
+info приходит из onIteration после каждой итерации, bestmove - из onMove.
+При go ponder и go infinite bestmove придерживается до ponderhit/stop, как требует протокол.
+*/
+class Uci 
+{
+public:
+
+    explicit Uci(std::ostream& out);
+    ~Uci();
+
+    // читает команды до quit или конца ввода
+    void run(std::istream& in);
+
+private:
+
+    void uci();
+    void isready();
+    void setoption(std::istringstream&);
+    void position(std::istringstream&);
+    void go(std::istringstream&);
+    void stop();
+    void ponderhit();
+    void newgame();
+
+    // применяет измененные setoption (пересоздает потоки и таблицу), только между поисками
+    void init();
+    // останавливает поиск и ждет bestmove
+    void wait();
+    std::optional<Core::Logic::Move> parse_move(const std::string&);
+
+    void on_iteration(const Core::Engine::Search::Info&);
+    void on_move(const Core::Engine::Search::Info&);
+    void send_best(const Core::Engine::Search::Info&);
+    void send(const std::string&);
+
+private:
+
+    std::ostream& out;
+    std::mutex outMtx;
+
+    Core::Engine::Search::Options options;
+    bool dirty = true;
+    bool launched = false;
+    int moveOverheadMs = 30;
+
+    Core::Logic::PositionDM pos;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool searching = false;
+    // bestmove не отправляется, пока идет ponder или go infinite
+    bool holding = false;
+    std::optional<Core::Engine::Search::Info> pending;
+    // время на ход, которое начнет действовать после ponderhit
+    std::chrono::milliseconds ponderBudget{0};
+    std::chrono::steady_clock::time_point goStart;
+
+    // последним: поток поиска останавливается раньше, чем разрушаются поля выше
+    Core::Engine::Search search;
+
+};